@@ -0,0 +1,58 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_ASCII_HPP
+#define HTTP_ASCII_HPP
+
+#include <string_view>
+
+namespace http {
+
+/**
+ * @brief Fold an ASCII character to lower case
+ *
+ * @param c:
+ * The character to fold
+ *
+ * @return The lower case equivalent of {c}
+ */
+constexpr char to_lower(const char c) noexcept {
+  return (c >= 'A' and c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+/**
+ * @brief Case-insensitive comparison of two ASCII strings, such
+ * as field names or file extensions
+ *
+ * No locale is consulted and nothing is allocated
+ *
+ * @return true if the strings are equal ignoring case,
+ * false otherwise
+ */
+constexpr bool iequals(std::string_view lhs, std::string_view rhs) noexcept {
+  if (lhs.size() not_eq rhs.size()) return false;
+  //-----------------------------------
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    if (lhs[i] not_eq rhs[i] and to_lower(lhs[i]) not_eq to_lower(rhs[i])) return false;
+  }
+  //-----------------------------------
+  return true;
+}
+
+} //< namespace http
+
+#endif //< HTTP_ASCII_HPP
@@ -0,0 +1,562 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_BODY_HPP
+#define HTTP_BODY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <cerrno>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <stdexcept>
+#include <memory_resource>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/types.h>
+
+namespace http {
+
+/**
+ * @brief This class is used to represent an error that occurred
+ * from within the operations of class Body
+ */
+class Body_error : public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
+/**
+ * @brief This class receives a serialized message piece by piece,
+ * in the order the pieces are to be sent
+ *
+ * Derive from it to write to a connection. {write_file} reads the
+ * region in blocks and hands them to {write}; override it to pass
+ * the region to {sendfile} instead so the bytes never enter memory
+ */
+class Writer {
+public:
+  /**
+   * @brief Default destructor
+   */
+  virtual ~Writer() noexcept = default;
+
+  /**
+   * @brief Write a run of bytes
+   *
+   * @param bytes:
+   * The bytes to write, valid only for the duration of the call
+   */
+  virtual void write(std::string_view bytes) = 0;
+
+  /**
+   * @brief Write a region of a file
+   *
+   * @param fd:
+   * The file descriptor
+   *
+   * @param offset:
+   * The offset of the region within the file
+   *
+   * @param length:
+   * The number of bytes in the region
+   *
+   * @note Throws {Body_error} if the region cannot be read
+   */
+  virtual void write_file(const int fd, const off_t offset, const std::size_t length);
+}; //< class Writer
+
+/**
+ * @brief A writer that appends to a string
+ */
+class String_writer : public Writer {
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param out:
+   * The string to append to, which must outlive this object
+   */
+  explicit String_writer(std::string& out) noexcept
+    : out_{out}
+  {}
+
+  void write(std::string_view bytes) override
+  { out_.append(bytes); }
+private:
+  std::string& out_;
+}; //< class String_writer
+
+/**
+ * @brief This class is used to represent the entity of an HTTP
+ * message, held in one of several ways:
+ *
+ * Buffer    - The bytes in one piece, owned by the body
+ * Rope      - The bytes as a list of chunks, so appending never moves
+ *             the bytes already added
+ * File      - A region of a file, written with {sendfile} by a
+ *             writer that supports it
+ * Generator - A callback that produces the bytes when the body
+ *             is written, so they never need to be held at once
+ *
+ * Clearing a body keeps the storage of its buffer for the next use
+ */
+class Body {
+public:
+  /**
+   * @brief How the bytes of a body are held
+   */
+  enum class Kind {
+    Buffer,
+    Rope,
+    File,
+    Generator
+  };
+
+  /**
+   * @brief A region of a file, which the body does not own
+   */
+  struct File_region {
+    int         fd;
+    off_t       offset;
+    std::size_t length;
+  };
+
+  /**
+   * @brief Produces the next bytes of a body
+   *
+   * Called with room for {capacity} bytes at {out}, it returns the
+   * number of bytes produced, with 0 signalling the end of the body
+   */
+  using Generator = std::function<std::size_t(char* out, std::size_t capacity)>;
+
+  /**
+   * @brief The size of a generated body whose length is not known
+   * up front
+   */
+  static constexpr std::size_t unknown_size {SIZE_MAX};
+
+  /**
+   * @brief The capacity of each chunk a rope starts for the
+   * bytes appended to it
+   */
+  static constexpr std::size_t chunk_capacity {4096};
+
+  /**
+   * @brief The number of bytes asked of a generator at a time
+   */
+  static constexpr std::size_t generator_block {16384};
+
+  /**
+   * @brief Construct an empty body
+   *
+   * @param resource:
+   * The memory resource the bytes are allocated from, which
+   * must outlive this object
+   */
+  explicit Body(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
+
+  /**
+   * @brief Get how the bytes of this body are held
+   *
+   * @return How the bytes of this body are held
+   */
+  Kind kind() const noexcept
+  { return kind_; }
+
+  /**
+   * @brief Get the number of bytes in this body
+   *
+   * @return The number of bytes, or {unknown_size} for a generator
+   * without a declared length
+   */
+  std::size_t size() const noexcept;
+
+  /**
+   * @brief Check if this body has no bytes
+   *
+   * @return true if the body is known to have no bytes, false otherwise
+   */
+  bool empty() const noexcept
+  { return size() == 0; }
+
+  /**
+   * @brief Check if the bytes of this body are held in memory
+   *
+   * @return true for a buffer or a rope, false otherwise
+   */
+  bool in_memory() const noexcept
+  { return kind_ == Kind::Buffer or kind_ == Kind::Rope; }
+
+  /**
+   * @brief Get the memory resource the bytes are allocated from
+   *
+   * @return The memory resource of this object
+   */
+  std::pmr::memory_resource* resource() const noexcept
+  { return buffer_.get_allocator().resource(); }
+
+  /**
+   * @brief Replace the contents with a copy of a run of bytes,
+   * held as a buffer
+   *
+   * @param bytes:
+   * The bytes to copy
+   *
+   * @return The object that invoked this method
+   */
+  Body& assign(std::string_view bytes);
+
+  /**
+   * @brief Append a copy of a run of bytes
+   *
+   * A buffer grows in place, a rope fills its last chunk before
+   * starting a new one. Any other body is replaced by a buffer
+   *
+   * @param bytes:
+   * The bytes to append
+   *
+   * @return The object that invoked this method
+   */
+  Body& append(std::string_view bytes);
+
+  /**
+   * @brief Append a chunk without copying it, turning the body
+   * into a rope
+   *
+   * @param chunk:
+   * The chunk, which is moved rather than copied when it uses the
+   * memory resource of this body
+   *
+   * @return The object that invoked this method
+   */
+  Body& append_chunk(std::pmr::string&& chunk);
+
+  /**
+   * @brief Turn an in-memory body into a rope, so later appends
+   * never move the bytes already added
+   *
+   * @return The object that invoked this method
+   */
+  Body& to_rope();
+
+  /**
+   * @brief Replace the contents with a region of a file
+   *
+   * @param region:
+   * The region, which must stay readable until the body is written
+   *
+   * @return The object that invoked this method
+   */
+  Body& assign_file(const File_region& region);
+
+  /**
+   * @brief Replace the contents with bytes produced by a callback
+   * when the body is written
+   *
+   * @param generator:
+   * The callback producing the bytes
+   *
+   * @param length:
+   * The number of bytes the callback produces, if known
+   *
+   * @return The object that invoked this method
+   */
+  Body& assign_generator(Generator generator, const std::size_t length = unknown_size);
+
+  /**
+   * @brief Get the bytes of a buffer
+   *
+   * @return The bytes of a buffer, else an empty view
+   */
+  std::string_view view() const noexcept
+  { return (kind_ == Kind::Buffer) ? std::string_view{buffer_} : std::string_view{}; }
+
+  /**
+   * @brief Get the chunks of a rope
+   *
+   * @return The chunks of a rope, empty for any other body
+   */
+  const std::pmr::vector<std::pmr::string>& chunks() const noexcept
+  { return chunks_; }
+
+  /**
+   * @brief Get the region of a file body
+   *
+   * @return The region of a file body, unspecified for any
+   * other body
+   */
+  const File_region& file() const noexcept
+  { return file_; }
+
+  /**
+   * @brief Remove the contents, keeping the storage
+   *
+   * @return The object that invoked this method
+   */
+  Body& clear() noexcept;
+
+  /**
+   * @brief Write the body piece by piece without gathering it
+   * into one buffer
+   *
+   * A generator is called until it signals the end of the body,
+   * so a generated body is written once
+   *
+   * @param out:
+   * Where to write
+   *
+   * @note Throws {Body_error} if a generator produces more or fewer
+   * bytes than its declared length, the bytes past that length
+   * never being written
+   */
+  void write_to(Writer& out) const;
+
+  /**
+   * @brief Copy the body into a caller buffer
+   *
+   * @param out:
+   * Where to write, with room for {size()} bytes
+   *
+   * @return Pointer past the last byte written
+   *
+   * @note Throws {Body_error} if the body has no known size or a
+   * file region cannot be read
+   */
+  char* copy_into(char* out) const;
+private:
+  //----------------------------------------
+  // Class data members
+  Kind                               kind_ {Kind::Buffer};
+  std::pmr::string                   buffer_;
+  std::pmr::vector<std::pmr::string> chunks_;
+  std::size_t                        rope_size_ {0};
+  File_region                        file_ {-1, 0, 0};
+  Generator                          generator_;
+  std::size_t                        generated_size_ {unknown_size};
+  //----------------------------------------
+
+  /**
+   * @brief Drop the contents of the other kinds when switching
+   * to a kind
+   */
+  void become(const Kind kind) noexcept;
+}; //< class Body
+
+/**--v----------- Implementation Details -----------v--**/
+
+inline void Writer::write_file(const int fd, const off_t offset, const std::size_t length) {
+  char block[Body::generator_block];
+  std::size_t done {0};
+  //-----------------------------------
+  while (done < length) {
+    const auto n = ::pread(fd, block, std::min(sizeof block, length - done),
+                           offset + static_cast<off_t>(done));
+    if (n < 0 and errno == EINTR) continue;
+    if (n <= 0) throw Body_error {"Unable to read the file region of a body"};
+    //-----------------------------------
+    write({block, static_cast<std::size_t>(n)});
+    done += static_cast<std::size_t>(n);
+  }
+}
+
+inline Body::Body(std::pmr::memory_resource* resource) noexcept
+  : buffer_{resource}
+  , chunks_{resource}
+{}
+
+inline std::size_t Body::size() const noexcept {
+  switch (kind_) {
+    case Kind::Buffer:    return buffer_.size();
+    case Kind::Rope:      return rope_size_;
+    case Kind::File:      return file_.length;
+    default:              return generated_size_;
+  }
+}
+
+inline void Body::become(const Kind kind) noexcept {
+  if (kind not_eq Kind::Buffer) buffer_.clear();
+  if (kind not_eq Kind::Rope) {
+    chunks_.clear();
+    rope_size_ = 0;
+  }
+  if (kind not_eq Kind::File) file_ = {-1, 0, 0};
+  if (kind not_eq Kind::Generator) {
+    generator_      = nullptr;
+    generated_size_ = unknown_size;
+  }
+  //-----------------------------------
+  kind_ = kind;
+}
+
+inline Body& Body::assign(std::string_view bytes) {
+  become(Kind::Buffer);
+  buffer_.assign(bytes.data(), bytes.size());
+  return *this;
+}
+
+inline Body& Body::append(std::string_view bytes) {
+  if (not in_memory()) become(Kind::Buffer);
+  //-----------------------------------
+  if (kind_ == Kind::Buffer) {
+    buffer_.append(bytes.data(), bytes.size());
+    return *this;
+  }
+  //-----------------------------------
+  rope_size_ += bytes.size();
+  //-----------------------------------
+  // A chunk is only filled up to its capacity, so it never moves
+  while (not bytes.empty()) {
+    if (chunks_.empty() or chunks_.back().size() >= chunks_.back().capacity()) {
+      chunks_.emplace_back().reserve(chunk_capacity);
+    }
+    //-----------------------------------
+    auto& chunk = chunks_.back();
+    const auto n = std::min(bytes.size(), chunk.capacity() - chunk.size());
+    chunk.append(bytes.data(), n);
+    bytes.remove_prefix(n);
+  }
+  //-----------------------------------
+  return *this;
+}
+
+inline Body& Body::append_chunk(std::pmr::string&& chunk) {
+  to_rope();
+  //-----------------------------------
+  if (chunk.empty()) return *this;
+  //-----------------------------------
+  rope_size_ += chunk.size();
+  chunks_.push_back(std::move(chunk));
+  //-----------------------------------
+  return *this;
+}
+
+inline Body& Body::to_rope() {
+  if (kind_ == Kind::Rope) return *this;
+  //-----------------------------------
+  if (kind_ not_eq Kind::Buffer) become(Kind::Buffer);
+  //-----------------------------------
+  // The buffer becomes the first chunk as is
+  if (not buffer_.empty()) {
+    rope_size_ = buffer_.size();
+    chunks_.push_back(std::move(buffer_));
+    buffer_.clear();
+  }
+  //-----------------------------------
+  kind_ = Kind::Rope;
+  return *this;
+}
+
+inline Body& Body::assign_file(const File_region& region) {
+  become(Kind::File);
+  file_ = region;
+  return *this;
+}
+
+inline Body& Body::assign_generator(Generator generator, const std::size_t length) {
+  become(Kind::Generator);
+  generator_      = std::move(generator);
+  generated_size_ = length;
+  return *this;
+}
+
+inline Body& Body::clear() noexcept {
+  become(Kind::Buffer);
+  buffer_.clear();
+  return *this;
+}
+
+inline void Body::write_to(Writer& out) const {
+  switch (kind_) {
+    case Kind::Buffer:
+      if (not buffer_.empty()) out.write(buffer_);
+      break;
+    case Kind::Rope:
+      for (const auto& chunk : chunks_) out.write(chunk);
+      break;
+    case Kind::File:
+      if (file_.length not_eq 0) out.write_file(file_.fd, file_.offset, file_.length);
+      break;
+    case Kind::Generator: {
+      if (not generator_) break;
+      //-----------------------------------
+      char block[generator_block];
+      std::size_t done {0};
+      while (const auto produced = generator_(block, sizeof block)) {
+        const auto n = std::min(produced, sizeof block);
+        if (generated_size_ not_eq unknown_size and n > generated_size_ - done) {
+          throw Body_error {"A generated body exceeded its declared length"};
+        }
+        out.write({block, n});
+        done += n;
+      }
+      //-----------------------------------
+      if (generated_size_ not_eq unknown_size and done not_eq generated_size_) {
+        throw Body_error {"A generated body ended before its declared length"};
+      }
+      break;
+    }
+  }
+}
+
+inline char* Body::copy_into(char* out) const {
+  switch (kind_) {
+    case Kind::Buffer:
+      return std::copy(buffer_.cbegin(), buffer_.cend(), out);
+    case Kind::Rope:
+      for (const auto& chunk : chunks_) out = std::copy(chunk.cbegin(), chunk.cend(), out);
+      return out;
+    case Kind::File: {
+      std::size_t done {0};
+      while (done < file_.length) {
+        const auto n = ::pread(file_.fd, out + done, file_.length - done,
+                               file_.offset + static_cast<off_t>(done));
+        if (n < 0 and errno == EINTR) continue;
+        if (n <= 0) throw Body_error {"Unable to read the file region of a body"};
+        done += static_cast<std::size_t>(n);
+      }
+      return out + done;
+    }
+    case Kind::Generator: {
+      if (generated_size_ == unknown_size) {
+        throw Body_error {"A generated body of unknown length cannot be copied into a buffer"};
+      }
+      //-----------------------------------
+      std::size_t done {0};
+      while (done < generated_size_ and generator_) {
+        const auto n = generator_(out + done, generated_size_ - done);
+        if (n == 0) break;
+        done += std::min(n, generated_size_ - done);
+      }
+      if (done not_eq generated_size_) {
+        throw Body_error {"A generated body ended before its declared length"};
+      }
+      return out + done;
+    }
+  }
+  //-----------------------------------
+  return out;
+}
+
+/**--^----------- Implementation Details -----------^--**/
+
+} //< namespace http
+
+#endif //< HTTP_BODY_HPP
@@ -0,0 +1,607 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_CHUNKED_HPP
+#define HTTP_CHUNKED_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
+
+#include "ascii.hpp"
+#include "body.hpp"
+#include "format.hpp"
+#include "header.hpp"
+
+namespace http {
+
+/**
+ * @brief Check if the chunked transfer coding is the final coding
+ * of a {Transfer-Encoding} field value
+ *
+ * @param transfer_encoding:
+ * The value of the field, a comma-separated list of codings
+ *
+ * @return true if the message body is chunked, false otherwise
+ */
+inline bool is_chunked(std::string_view transfer_encoding) noexcept {
+  const auto comma = transfer_encoding.rfind(',');
+  auto coding = (comma == std::string_view::npos) ? transfer_encoding : transfer_encoding.substr(comma + 1);
+  //-----------------------------------
+  const auto first = coding.find_first_not_of(" \t");
+  if (first == std::string_view::npos) return false;
+  coding.remove_prefix(first);
+  coding = coding.substr(0, coding.find_last_not_of(" \t") + 1);
+  //-----------------------------------
+  return iequals(coding, "chunked");
+}
+
+/**
+ * @brief Check if a field frames the message, so it must not be
+ * sent as a trailer field (RFC 7230 §4.1.2)
+ *
+ * @param name:
+ * The name of the field
+ *
+ * @return true if the field is {Content-Length} or
+ * {Transfer-Encoding}, false otherwise
+ */
+inline bool is_framing_field(std::string_view name) noexcept {
+  const auto id = header_fields::id(name);
+  return id == Header_id::Content_Length or id == Header_id::Transfer_Encoding;
+}
+
+/**
+ * @brief This class is used to represent an error that occurred
+ * from within the operations of class Chunked_decoder
+ */
+class Chunked_error : public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
+/**
+ * @brief This class is a push-style, resumable decoder for message
+ * bodies in the chunked transfer coding (RFC 7230 §4.1)
+ *
+ * Bytes are handed to the decoder with {feed} as they arrive. Chunk
+ * data is never copied; it is handed to the data handler as views
+ * into the segment that was fed, so a chunk split across segments
+ * arrives in several pieces. Only the chunk-size lines and trailer
+ * fields are collected, each bounded by the line limit
+ */
+class Chunked_decoder {
+public:
+  /**
+   * @brief Progress of the body being decoded
+   */
+  enum class Status {
+    Need_more,
+    Complete
+  };
+
+  /**
+   * @brief Receives the chunk extensions of each chunk as name and
+   * value, the value being empty if absent and unquoted if quoted
+   */
+  using Extension_handler = std::function<void(std::string_view name, std::string_view value)>;
+
+  /**
+   * @brief The body size of a decoder without a limit
+   */
+  static constexpr std::size_t unlimited {SIZE_MAX};
+
+  /**
+   * @brief Constructor
+   *
+   * @param max_body_size:
+   * Maximum number of bytes of chunk data
+   *
+   * @param max_line:
+   * Maximum number of bytes in a chunk-size line or trailer field
+   */
+  explicit Chunked_decoder(const std::size_t max_body_size = unlimited,
+                           const std::size_t max_line = 4096);
+
+  /**
+   * @brief Set the handler that receives chunk extensions
+   *
+   * Without a handler extensions are checked and discarded
+   *
+   * @param handler:
+   * The extension handler
+   *
+   * @return The object that invoked this method
+   */
+  Chunked_decoder& on_extension(Extension_handler handler);
+
+  /**
+   * @brief Set the maximum number of bytes of chunk data
+   *
+   * @param max_body_size:
+   * The maximum number of bytes
+   *
+   * @return The object that invoked this method
+   */
+  Chunked_decoder& set_max_body_size(const std::size_t max_body_size) noexcept;
+
+  /**
+   * @brief Decode the next segment of the body
+   *
+   * Decoding stops at the end of the body, so bytes following
+   * it are never consumed
+   *
+   * @param data:
+   * The segment to decode
+   *
+   * @param len:
+   * The number of bytes in the segment
+   *
+   * @param on_data:
+   * Called with each run of chunk data as a view into the segment
+   *
+   * @return The progress of the body
+   *
+   * @note Throws {Chunked_error} if the body is malformed or too
+   * large, and {Header_limit_error} if the trailer fields exceed
+   * the limits of {trailers()}
+   */
+  template <typename Handler>
+  Status feed(const char* data, const std::size_t len, Handler&& on_data);
+
+  /**
+   * @brief Decode the next segment of the body, discarding the
+   * chunk data
+   */
+  Status feed(const char* data, const std::size_t len)
+  { return feed(data, len, [](std::string_view) {}); }
+
+  /**
+   * @brief Get the number of bytes consumed by the last call
+   * to {feed}
+   *
+   * @return The number of bytes consumed
+   */
+  std::size_t consumed() const noexcept
+  { return consumed_; }
+
+  /**
+   * @brief Get the progress of the body
+   *
+   * @return The progress of the body
+   */
+  Status status() const noexcept
+  { return (state_ == State::Done) ? Status::Complete : Status::Need_more; }
+
+  /**
+   * @brief Get the number of bytes of chunk data decoded so far
+   *
+   * @return The number of bytes of chunk data
+   */
+  std::size_t body_size() const noexcept
+  { return body_size_; }
+
+  /**
+   * @brief Get the trailer fields, complete once the body is
+   *
+   * @return The trailer fields
+   */
+  const Header& trailers() const noexcept
+  { return trailers_; }
+
+  /**
+   * @brief Prepare the decoder for the next body
+   *
+   * Previously allocated capacity is retained
+   */
+  void reset() noexcept;
+private:
+  //----------------------------------------
+  // Internal state of the decoder
+  enum class State {
+    Size_line,
+    Data,
+    Data_end,
+    Trailer,
+    Done
+  };
+  //----------------------------------------
+  // Class data members
+  State             state_ {State::Size_line};
+  std::size_t       max_body_size_;
+  std::size_t       max_line_;
+  std::string       line_;
+  std::size_t       remaining_ {0};
+  std::size_t       body_size_ {0};
+  std::size_t       consumed_ {0};
+  bool              seen_cr_ {false};
+  Header            trailers_;
+  Extension_handler extension_handler_;
+  //----------------------------------------
+
+  /**
+   * @brief Parse a complete chunk-size line
+   */
+  void complete_size_line(std::string_view line);
+
+  /**
+   * @brief Add a complete trailer field line, the empty line
+   * ending the body
+   */
+  void complete_trailer_line(std::string_view line);
+}; //< class Chunked_decoder
+
+/**
+ * @brief This class frames a body of unknown length in the chunked
+ * transfer coding (RFC 7230 §4.1) as it is produced
+ *
+ * Each run of bytes written to the encoder goes out as one chunk,
+ * so it can be handed any body with {Body::write_to}. A file region
+ * is passed through to {Writer::write_file} of the underlying
+ * writer between its chunk-size line and the line ending the chunk
+ *
+ * The body is ended with {finish}, optionally followed by trailer
+ * fields
+ */
+class Chunked_encoder : public Writer {
+public:
+  /**
+   * @brief Pieces up to this size are written together with their
+   * framing in a single call to the underlying writer
+   */
+  static constexpr std::size_t coalesce_limit {1024};
+
+  /**
+   * @brief Constructor
+   *
+   * @param out:
+   * Where the framed body is written, which must outlive this object
+   */
+  explicit Chunked_encoder(Writer& out) noexcept
+    : out_{out}
+  {}
+
+  /**
+   * @brief Write a run of bytes as one chunk, an empty run
+   * being ignored as it would end the body
+   *
+   * @param bytes:
+   * The bytes of the chunk
+   *
+   * @note Throws {Chunked_error} if the body was finished
+   */
+  void write(std::string_view bytes) override;
+
+  /**
+   * @brief Write a region of a file as one chunk
+   *
+   * @param fd:
+   * The file descriptor
+   *
+   * @param offset:
+   * The offset of the region within the file
+   *
+   * @param length:
+   * The number of bytes in the region
+   *
+   * @note Throws {Chunked_error} if the body was finished
+   */
+  void write_file(const int fd, const off_t offset, const std::size_t length) override;
+
+  /**
+   * @brief End the body with the last chunk and an empty
+   * trailer section
+   *
+   * @note Throws {Chunked_error} if the body was finished
+   */
+  void finish();
+
+  /**
+   * @brief End the body with the last chunk and a trailer section
+   *
+   * @param trailers:
+   * The trailer fields
+   *
+   * @note Throws {Chunked_error} if the body was finished or a
+   * trailer field frames the message
+   */
+  void finish(const Header& trailers);
+
+  /**
+   * @brief Check if the body was ended
+   *
+   * @return true if {finish} was called, false otherwise
+   */
+  bool finished() const noexcept
+  { return finished_; }
+
+  /**
+   * @brief Get the number of body bytes written so far,
+   * excluding the framing
+   *
+   * @return The number of body bytes written
+   */
+  std::size_t body_size() const noexcept
+  { return body_size_; }
+private:
+  //----------------------------------------
+  // Class data members
+  Writer&     out_;
+  std::string frame_;
+  std::size_t body_size_ {0};
+  bool        finished_ {false};
+  //----------------------------------------
+
+  /**
+   * @brief Write the chunk-size line of a chunk
+   */
+  void write_size_line(const std::size_t size);
+
+  /**
+   * @brief Ensure the body is not finished
+   */
+  void check_open() const;
+}; //< class Chunked_encoder
+
+/**--v----------- Implementation Details -----------v--**/
+
+inline Chunked_decoder::Chunked_decoder(const std::size_t max_body_size, const std::size_t max_line)
+  : max_body_size_{max_body_size}
+  , max_line_{max_line}
+{}
+
+inline Chunked_decoder& Chunked_decoder::on_extension(Extension_handler handler) {
+  extension_handler_ = std::move(handler);
+  return *this;
+}
+
+inline Chunked_decoder& Chunked_decoder::set_max_body_size(const std::size_t max_body_size) noexcept {
+  max_body_size_ = max_body_size;
+  return *this;
+}
+
+template <typename Handler>
+inline Chunked_decoder::Status Chunked_decoder::feed(const char* data, const std::size_t len, Handler&& on_data) {
+  const char* cursor = data;
+  const char* const end = data + len;
+  //-----------------------------------
+  while (cursor < end and state_ not_eq State::Done) {
+    switch (state_) {
+      case State::Data: {
+        const auto n = std::min(static_cast<std::size_t>(end - cursor), remaining_);
+        on_data(std::string_view{cursor, n});
+        cursor     += n;
+        remaining_ -= n;
+        if (remaining_ == 0) state_ = State::Data_end;
+        break;
+      }
+      case State::Data_end: {
+        if (*cursor == '\r' and not seen_cr_) {
+          seen_cr_ = true;
+          ++cursor;
+          break;
+        }
+        if (*cursor not_eq '\n') throw Chunked_error {"Missing line-ending after chunk data"};
+        //-----------------------------------
+        seen_cr_ = false;
+        ++cursor;
+        state_ = State::Size_line;
+        break;
+      }
+      default: {
+        auto eol = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        auto segment_end = (eol == nullptr) ? end : eol + 1;
+        //-----------------------------------
+        if (line_.size() + (segment_end - cursor) > max_line_) {
+          throw Chunked_error {"Chunk line exceeds " + std::to_string(max_line_) + " bytes"};
+        }
+        //-----------------------------------
+        line_.append(cursor, segment_end);
+        cursor = segment_end;
+        //-----------------------------------
+        if (eol == nullptr) break;
+        //-----------------------------------
+        std::string_view line {line_.data(), line_.size() - 1};
+        if (not line.empty() and line.back() == '\r') line.remove_suffix(1);
+        //-----------------------------------
+        if (state_ == State::Size_line) complete_size_line(line);
+        else complete_trailer_line(line);
+        //-----------------------------------
+        line_.clear();
+        break;
+      }
+    }
+  }
+  //-----------------------------------
+  consumed_ = cursor - data;
+  return status();
+}
+
+inline void Chunked_decoder::complete_size_line(std::string_view line) {
+  auto is_space = [](const char c) { return c == ' ' or c == '\t'; };
+  auto is_tchar = [](const char c) {
+    return (c >= '0' and c <= '9') or (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z')
+           or (c not_eq '\0' and std::strchr("!#$%&'*+-.^_`|~", c) not_eq nullptr);
+  };
+  //-----------------------------------
+  std::size_t size {0};
+  std::size_t i {0};
+  //-----------------------------------
+  for (; i < line.size(); ++i) {
+    const char c = to_lower(line[i]);
+    int digit;
+    if (c >= '0' and c <= '9') digit = c - '0';
+    else if (c >= 'a' and c <= 'f') digit = c - 'a' + 10;
+    else break;
+    //-----------------------------------
+    if (i == 15) throw Chunked_error {"Chunk size too large"};
+    size = (size << 4) | static_cast<std::size_t>(digit);
+  }
+  //-----------------------------------
+  if (i == 0) throw Chunked_error {"Invalid chunk size"};
+  //-----------------------------------
+  // chunk-ext = *( BWS ";" BWS ext-name [ BWS "=" BWS ext-val ] )
+  while (i < line.size()) {
+    while (i < line.size() and is_space(line[i])) ++i;
+    if (i == line.size()) break;
+    if (line[i] not_eq ';') throw Chunked_error {"Invalid chunk extension"};
+    ++i;
+    while (i < line.size() and is_space(line[i])) ++i;
+    //-----------------------------------
+    const auto name_begin = i;
+    while (i < line.size() and is_tchar(line[i])) ++i;
+    if (i == name_begin) throw Chunked_error {"Invalid chunk extension"};
+    const auto name = line.substr(name_begin, i - name_begin);
+    //-----------------------------------
+    std::string_view value;
+    auto j = i;
+    while (j < line.size() and is_space(line[j])) ++j;
+    if (j < line.size() and line[j] == '=') {
+      i = j + 1;
+      while (i < line.size() and is_space(line[i])) ++i;
+      //-----------------------------------
+      if (i < line.size() and line[i] == '"') {
+        const auto value_begin = ++i;
+        while (i < line.size() and line[i] not_eq '"') i += (line[i] == '\\') ? 2 : 1;
+        if (i >= line.size()) throw Chunked_error {"Invalid chunk extension"};
+        value = line.substr(value_begin, i - value_begin);
+        ++i;
+      } else {
+        const auto value_begin = i;
+        while (i < line.size() and is_tchar(line[i])) ++i;
+        if (i == value_begin) throw Chunked_error {"Invalid chunk extension"};
+        value = line.substr(value_begin, i - value_begin);
+      }
+    }
+    //-----------------------------------
+    if (extension_handler_) extension_handler_(name, value);
+  }
+  //-----------------------------------
+  if (size == 0) {
+    state_ = State::Trailer;
+    return;
+  }
+  //-----------------------------------
+  if (size > max_body_size_ - body_size_) {
+    throw Chunked_error {"Chunked body exceeds " + std::to_string(max_body_size_) + " bytes"};
+  }
+  //-----------------------------------
+  body_size_ += size;
+  remaining_  = size;
+  state_      = State::Data;
+}
+
+inline void Chunked_decoder::complete_trailer_line(std::string_view line) {
+  if (line.empty()) {
+    state_ = State::Done;
+    return;
+  }
+  //-----------------------------------
+  if (line.front() == ' ' or line.front() == '\t') throw Chunked_error {"Folded trailer field"};
+  //-----------------------------------
+  const auto colon = line.find(':');
+  if (colon == std::string_view::npos or not is_field_name(line.substr(0, colon))
+      or line.find('\r') not_eq std::string_view::npos)
+  {
+    throw Chunked_error {"Invalid trailer field"};
+  }
+  //-----------------------------------
+  // Fields that frame the message must not be sent as trailers
+  const auto name = line.substr(0, colon);
+  if (is_framing_field(name)) throw Chunked_error {"Framing field in trailer: " + std::string{name}};
+  //-----------------------------------
+  trailers_.add_fields(line.data(), line.data() + line.size());
+}
+
+inline void Chunked_decoder::reset() noexcept {
+  state_     = State::Size_line;
+  remaining_ = 0;
+  body_size_ = 0;
+  consumed_  = 0;
+  seen_cr_   = false;
+  line_.clear();
+  trailers_.clear();
+}
+
+inline void Chunked_encoder::write(std::string_view bytes) {
+  check_open();
+  if (bytes.empty()) return;
+  //-----------------------------------
+  body_size_ += bytes.size();
+  //-----------------------------------
+  if (bytes.size() > coalesce_limit) {
+    write_size_line(bytes.size());
+    out_.write(bytes);
+    return out_.write("\r\n");
+  }
+  //-----------------------------------
+  frame_.resize(format::hex_size(bytes.size()) + 2 + bytes.size() + 2);
+  auto out = format::write_hex(&frame_[0], bytes.size());
+  out = format::write(out, "\r\n");
+  out = format::write(out, bytes);
+  format::write(out, "\r\n");
+  out_.write(frame_);
+}
+
+inline void Chunked_encoder::write_file(const int fd, const off_t offset, const std::size_t length) {
+  check_open();
+  if (length == 0) return;
+  //-----------------------------------
+  body_size_ += length;
+  write_size_line(length);
+  out_.write_file(fd, offset, length);
+  out_.write("\r\n");
+}
+
+inline void Chunked_encoder::finish() {
+  check_open();
+  finished_ = true;
+  out_.write("0\r\n\r\n");
+}
+
+inline void Chunked_encoder::finish(const Header& trailers) {
+  check_open();
+  for (const auto field : trailers) {
+    if (is_framing_field(field.name)) {
+      throw Chunked_error {"Framing field in trailer: " + std::string{field.name}};
+    }
+  }
+  finished_ = true;
+  //-----------------------------------
+  frame_.resize(3 + trailers.serialized_size());
+  trailers.serialize_into(format::write(&frame_[0], "0\r\n"));
+  out_.write(frame_);
+}
+
+inline void Chunked_encoder::write_size_line(const std::size_t size) {
+  char line[format::hex_size(SIZE_MAX) + 2];
+  format::write(format::write_hex(line, size), "\r\n");
+  out_.write({line, format::hex_size(size) + 2});
+}
+
+inline void Chunked_encoder::check_open() const {
+  if (finished_) throw Chunked_error {"Chunked body already finished"};
+}
+
+/**--^----------- Implementation Details -----------^--**/
+
+} //< namespace http
+
+#endif //< HTTP_CHUNKED_HPP
@@ -0,0 +1,161 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_FORMAT_HPP
+#define HTTP_FORMAT_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace http {
+namespace format {
+
+/**
+ * @brief Get the number of decimal digits needed to
+ * write a number
+ *
+ * @param n:
+ * The number
+ *
+ * @return The number of digits
+ */
+constexpr std::size_t decimal_size(std::size_t n) noexcept {
+  std::size_t size {1};
+  while (n >= 10) {
+    n /= 10;
+    ++size;
+  }
+  return size;
+}
+
+/**
+ * @brief Write a number in decimal
+ *
+ * @param out:
+ * Where to write, with room for {decimal_size(n)} bytes
+ *
+ * @param n:
+ * The number
+ *
+ * @return Pointer past the last byte written
+ */
+inline char* write_decimal(char* out, std::size_t n) noexcept {
+  char* const end = out + decimal_size(n);
+  char* cursor    = end;
+  do {
+    *--cursor = static_cast<char>('0' + (n % 10));
+    n /= 10;
+  } while (n not_eq 0);
+  return end;
+}
+
+/**
+ * @brief Get the number of hexadecimal digits needed to
+ * write a number
+ *
+ * @param n:
+ * The number
+ *
+ * @return The number of digits
+ */
+constexpr std::size_t hex_size(std::size_t n) noexcept {
+  std::size_t size {1};
+  while (n >= 16) {
+    n >>= 4;
+    ++size;
+  }
+  return size;
+}
+
+/**
+ * @brief Write a number in lowercase hexadecimal
+ *
+ * @param out:
+ * Where to write, with room for {hex_size(n)} bytes
+ *
+ * @param n:
+ * The number
+ *
+ * @return Pointer past the last byte written
+ */
+inline char* write_hex(char* out, std::size_t n) noexcept {
+  char* const end = out + hex_size(n);
+  char* cursor    = end;
+  do {
+    *--cursor = "0123456789abcdef"[n & 0xF];
+    n >>= 4;
+  } while (n not_eq 0);
+  return end;
+}
+
+/**
+ * @brief Write a sequence of bytes
+ *
+ * @param out:
+ * Where to write, with room for {bytes.size()} bytes
+ *
+ * @param bytes:
+ * The bytes to write
+ *
+ * @return Pointer past the last byte written
+ */
+inline char* write(char* out, std::string_view bytes) noexcept {
+  if (not bytes.empty()) std::memcpy(out, bytes.data(), bytes.size());
+  return out + bytes.size();
+}
+
+/**
+ * @brief Write a short sequence of bytes (at most 64) with a pair
+ * of fixed-size overlapping copies, avoiding the setup cost of a
+ * variable-length copy
+ *
+ * @param out:
+ * Where to write, with room for {bytes.size()} bytes
+ *
+ * @param bytes:
+ * The bytes to write
+ *
+ * @return Pointer past the last byte written
+ */
+inline char* write_short(char* out, std::string_view bytes) noexcept {
+  const char* const in = bytes.data();
+  const std::size_t n  = bytes.size();
+  //-----------------------------------
+  if (n >= 32) {
+    std::memcpy(out, in, 32);
+    std::memcpy(out + n - 32, in + n - 32, 32);
+  }
+  else if (n >= 16) {
+    std::memcpy(out, in, 16);
+    std::memcpy(out + n - 16, in + n - 16, 16);
+  }
+  else if (n >= 8) {
+    std::memcpy(out, in, 8);
+    std::memcpy(out + n - 8, in + n - 8, 8);
+  }
+  else {
+    for (std::size_t i = 0; i < n; ++i) out[i] = in[i];
+  }
+  //-----------------------------------
+  return out + n;
+}
+
+} //< namespace format
+} //< namespace http
+
+#endif //< HTTP_FORMAT_HPP
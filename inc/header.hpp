@@ -18,33 +18,166 @@
 #ifndef HTTP_HEADER_HPP
 #define HTTP_HEADER_HPP
 
+#include <array>
 #include <cctype>
+#include <cstdint>
 #include <utility>
+#include <iterator>
+#include <string_view>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstddef>
 #include <ostream>
-#include <sstream>
+#include <stdexcept>
+#include <memory_resource>
 #include <algorithm>
 #include <type_traits>
 
 #include "common.hpp"
+#include "format.hpp"
+#include "scanner.hpp"
 #include "header_fields.hpp" //< Standard header field names
+#include "status_code_constants.hpp"
 
 namespace http {
 
+/**
+ * @brief Case-insensitive hash of a field name (FNV-1a over
+ * the lower case bytes)
+ *
+ * @param name:
+ * The field name to hash
+ *
+ * @return The hash of the field name
+ */
+constexpr uint32_t field_hash(std::string_view name) noexcept {
+  uint32_t hash {2166136261u};
+  //-----------------------------------
+  for (const char c : name) {
+    hash = (hash ^ static_cast<unsigned char>(to_lower(c))) * 16777619u;
+  }
+  //-----------------------------------
+  return hash;
+}
+
+/**
+ * @brief Check that a field name holds no whitespace, control
+ * characters or DEL
+ *
+ * Whitespace between a field name and its colon makes the name
+ * invalid, so such a field line is rejected (RFC 7230 §3.2.4)
+ *
+ * @param name:
+ * The field name to check
+ *
+ * @return true if the name is valid, false otherwise
+ */
+constexpr bool is_field_name(std::string_view name) noexcept {
+  if (name.empty()) return false;
+  //-----------------------------------
+  for (const char c : name) {
+    if (static_cast<unsigned char>(c) <= ' ' or c == '\x7f') return false;
+  }
+  //-----------------------------------
+  return true;
+}
+
+/**
+ * @brief Caps on the size of a header section
+ *
+ * Storage grows with the fields actually added, so these bound
+ * what a peer can make a message hold rather than what every
+ * message reserves up front
+ */
+struct Header_limits {
+  Limit fields {25};    //< Maximum number of fields
+  Limit line   {8192};  //< Maximum bytes in a field line, folded lines included
+  Limit total  {65536}; //< Maximum bytes of the names and values of all fields
+};
+
 /**
  * @brief This class is used to store header information
  * associated with an HTTP message
  *
  * By default it is limited to 25 fields but the amount
  * can be specified by using the appropriate constructor
- * and provided method
+ * and provided method. The {Header_limits} bound what a peer
+ * can make a parsed header section hold: exceeding any of them
+ * with {add_fields} raises {Header_limit_error}. Fields added
+ * one at a time, as when building a message, are not limited
+ *
+ * The names and values of all fields live back to back in a
+ * single byte buffer and each field is a 20-byte entry of offsets
+ * into it, so walking or searching the fields touches a couple of
+ * cache lines rather than a heap block per name and value
  */
 class Header {
+public:
+  /**
+   * @brief A field of the header section as views into the
+   * storage of the header, valid until the header is modified
+   */
+  struct Field {
+    std::string_view name;
+    std::string_view value;
+  };
 private:
+  //-----------------------------------------------
+  // A field as offsets into {bytes_} along with the
+  // hash of its name, so lookups only compare names
+  // whose hash matches, and its well-known identifier
+  struct Entry {
+    uint32_t  name_offset;
+    uint32_t  value_offset;
+    uint32_t  value_size;
+    uint32_t  hash;
+    uint16_t  name_size;
+    Header_id id;
+  };
   //-----------------------------------------------
   // Internal class type aliases
-  using Const_iterator = Header_set::const_iterator;
+  using Entry_set      = std::pmr::vector<Entry>;
+  using Entry_iterator = Entry_set::const_iterator;
+  using Slot_table     = std::array<uint16_t, header_fields::count>;
   //-----------------------------------------------
 public:
+  /**
+   * @brief Iterator over the fields in the order they were added
+   */
+  class Const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type        = Field;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = Field;
+
+    Field operator * () const noexcept
+    { return header_->field(*entry_); }
+
+    Const_iterator& operator ++ () noexcept
+    { ++entry_; return *this; }
+
+    Const_iterator operator ++ (int) noexcept
+    { auto it = *this; ++entry_; return it; }
+
+    bool operator == (const Const_iterator& other) const noexcept
+    { return entry_ == other.entry_; }
+
+    bool operator != (const Const_iterator& other) const noexcept
+    { return entry_ not_eq other.entry_; }
+  private:
+    friend class Header;
+
+    Const_iterator(const Header* header, Entry_iterator entry) noexcept
+      : header_{header}, entry_{entry}
+    {}
+
+    const Header*  header_;
+    Entry_iterator entry_;
+  }; //< class Const_iterator
+
   /**
    * @brief Default constructor that limits the amount
    * of fields that can be added to 25
@@ -57,8 +190,28 @@ public:
    *
    * @param limit:
    * Capacity of how many fields that can be added
+   *
+   * @param resource:
+   * The memory resource the fields are allocated from, which
+   * must outlive this object
+   */
+  explicit Header(const Limit limit,
+                  std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
+
+  /**
+   * @brief Constructor to specify all caps on the size of
+   * the header section
+   *
+   * @param limits:
+   * The caps on the number of fields, the length of a field
+   * line and the bytes of all fields
+   *
+   * @param resource:
+   * The memory resource the fields are allocated from, which
+   * must outlive this object
    */
-  explicit Header(const Limit limit) noexcept;
+  explicit Header(const Header_limits& limits,
+                  std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
 
   /**
    * @brief Constructor that takes a stream of characters
@@ -70,14 +223,15 @@ public:
    *
    * @param limit:
    * Capacity of how many fields can be added
+   *
+   * @note Throws as {add_fields} does
    */
   template
   <
     typename T,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<T>>>::value>
+               <std::is_convertible
+               <T, std::string_view>::value>
   >
   explicit Header(T&& header_data, const Limit limit = 25);
 
@@ -109,6 +263,8 @@ public:
   /**
    * @brief Set the limit of how many fields can be added
    *
+   * No storage is reserved, it grows as fields are added
+   *
    * @param limit:
    * Capacity of how many fields can be added
    */
@@ -121,6 +277,46 @@ public:
    */
   Limit get_limit() const noexcept;
 
+  /**
+   * @brief Set all caps on the size of the header section
+   *
+   * Fields already added are not checked against the new caps
+   *
+   * @param limits:
+   * The caps on the number of fields, the length of a field
+   * line and the bytes of all fields
+   */
+  void set_limits(const Header_limits& limits) noexcept
+  { limits_ = limits; }
+
+  /**
+   * @brief Get the caps on the size of the header section
+   *
+   * @return The caps on the size of the header section
+   */
+  const Header_limits& get_limits() const noexcept
+  { return limits_; }
+
+  /**
+   * @brief Get the memory resource the fields are allocated from
+   *
+   * @return The memory resource of this object
+   */
+  std::pmr::memory_resource* resource() const noexcept
+  { return fields_.get_allocator().resource(); }
+
+  /**
+   * @brief Iterator to the first field
+   */
+  Const_iterator begin() const noexcept
+  { return {this, fields_.cbegin()}; }
+
+  /**
+   * @brief Iterator past the last field
+   */
+  Const_iterator end() const noexcept
+  { return {this, fields_.cend()}; }
+
   /**
    * @brief Add a new field to the current set
    *
@@ -130,18 +326,17 @@ public:
    * @tparam V value:
    * The field value
    *
-   * @return true if the field was added, false otherwise
+   * @return true if the field was added, false if its name
+   * is invalid
    */
   template
   <
     typename F, typename V,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value and
-                std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<V>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value and
+                std::is_convertible
+               <V, std::string_view>::value>
   >
   bool add_field(F&& field, V&& value);
 
@@ -154,23 +349,46 @@ public:
    * ...
    *
    * @tparam D data - The set of fields to add
+   *
+   * @note Throws as the overload taking a range of bytes does
    */
   template
   <
     typename D,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<D>>>::value>
+               <std::is_convertible
+               <D, std::string_view>::value>
   >
   void add_fields(D&& data);
 
+  /**
+   * @brief Add a set of fields to the current set from a range
+   * of bytes in the same format, stopping at the empty line that
+   * ends a header section
+   *
+   * A malformed line rejects the whole range, as skipping it could
+   * hide the fields that frame the message
+   *
+   * @param begin:
+   * The start of the range
+   *
+   * @param end:
+   * The end of the range
+   *
+   * @return Pointer to the first byte after the empty line, or {end}
+   * if there is none
+   *
+   * @note Throws {Header_limit_error} once a field would exceed the
+   * limits of this header, and {Header_error} at a malformed line,
+   * leaving the fields added before it
+   */
+  const char* add_fields(const char* const begin, const char* const end);
+
   /**
    * @brief Change the value of the specified field
    *
    * If the field is absent from the set it will
-   * be added with the associated value once its
-   * within capacity
+   * be added with the associated value
    *
    * @tparam F field:
    * The name of the field
@@ -184,12 +402,10 @@ public:
   <
     typename F, typename V,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value and
-                std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<V>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value and
+                std::is_convertible
+               <V, std::string_view>::value>
   >
   bool set_field(F&& field, V&& value);
 
@@ -202,17 +418,27 @@ public:
    * The name of the field
    *
    * @return The value associated with the specified
-   * field name
+   * field name, or an empty view if absent
    */
   template
   <
     typename F,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value>
   >
-  const std::string& get_value(F&& field) const noexcept;
+  std::string_view get_value(F&& field) const noexcept;
+
+  /**
+   * @brief Get the value associated with a well-known field
+   *
+   * @param id:
+   * The identifier of the field
+   *
+   * @return The value associated with the first field with
+   * the specified identifier, or an empty view if absent
+   */
+  std::string_view get_value(const Header_id id) const noexcept;
 
   /**
    * @brief Check to see if the specified field is a
@@ -227,12 +453,24 @@ public:
   <
     typename F,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value>
   >
   bool has_field(F&& field) const noexcept;
 
+  /**
+   * @brief Check to see if a well-known field is a member
+   * of the set of fields
+   *
+   * This is a single array index
+   *
+   * @param id:
+   * The identifier of the field
+   *
+   * @return true if the field is a member, false otherwise
+   */
+  bool has_field(const Header_id id) const noexcept;
+
   /**
    * @brief Check to see if the set of fields is empty
    *
@@ -260,18 +498,47 @@ public:
   <
     typename F,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value>
   >
   void erase(F&& field) noexcept;
 
   /**
    * @brief Remove all fields from the set of fields leaving
    * it empty
+   *
+   * The storage of the removed fields is kept and reused by
+   * fields added later
    */
   void clear() noexcept;
 
+  /**
+   * @brief Get the number of bytes written by {serialize_into}
+   *
+   * @return The serialized size including the empty line that
+   * ends the header section
+   */
+  std::size_t serialized_size() const noexcept;
+
+  /**
+   * @brief Write the header section including the empty line
+   * that ends it
+   *
+   * @param out:
+   * Where to write, with room for {serialized_size()} bytes
+   *
+   * @return Pointer past the last byte written
+   */
+  char* serialize_into(char* out) const noexcept;
+
+  /**
+   * @brief Append the header section to a string
+   *
+   * @param out:
+   * The string to append to
+   */
+  void append_to(std::string& out) const;
+
   /**
    * @brief Get a string representation of this
    * class
@@ -288,28 +555,115 @@ public:
 private:
   //-----------------------------------------------
   // Class data members
-  Header_set fields_;
+  Entry_set        fields_;
+  std::pmr::string bytes_;       //< Names and values of the fields
+  Header_limits    limits_;
+  std::size_t      garbage_ {0}; //< Bytes of {bytes_} no longer referred to by a field
+  Slot_table       slots_ {};    //< 1-based index of the first field per {Header_id}, 0 if absent
   //-----------------------------------------------
 
+  /**
+   * @brief Get the name and value of an entry
+   */
+  Field field(const Entry& entry) const noexcept
+  { return {{bytes_.data() + entry.name_offset, entry.name_size},
+            {bytes_.data() + entry.value_offset, entry.value_size}}; }
+
+  /**
+   * @brief Check that one more field can be added
+   */
+  void check_count() const;
+
+  /**
+   * @brief Check that a field line and the bytes it adds to
+   * the fields are within the limits
+   *
+   * @param line:
+   * The length of the field line
+   *
+   * @param added:
+   * The bytes the field line adds to the names and values
+   */
+  void check_size(const std::size_t line, const std::size_t added) const;
+
+  /**
+   * @brief Append a field with an empty value
+   *
+   * The caller is responsible for checking the capacity
+   *
+   * @param name:
+   * The name of the field, at most UINT16_MAX bytes
+   *
+   * @return The new field
+   */
+  Entry& append(std::string_view name);
+
+  /**
+   * @brief Extend the value of the last field
+   *
+   * @param entry:
+   * The last field
+   *
+   * @param bytes:
+   * The bytes to append to its value
+   */
+  void append_value(Entry& entry, std::string_view bytes);
+
+  /**
+   * @brief Replace the value of a field, in place if the new
+   * value fits
+   *
+   * @param entry:
+   * The field
+   *
+   * @param value:
+   * The new value
+   */
+  void assign_value(Entry& entry, std::string_view value);
+
+  /**
+   * @brief Drop the bytes no longer referred to by a field once
+   * they make up more than half of the buffer
+   */
+  void collect();
+
+  /**
+   * @brief Rebuild the slot table from the set of fields
+   */
+  void index() noexcept;
+
+  /**
+   * @brief Enter the field at a 1-based position in the slot
+   * table unless an earlier field has the same identifier
+   */
+  void index(const std::size_t position) noexcept;
+
   /**
    * @brief Find the location of a field within the set of
    * fields
    *
-   * @tparam F field:
+   * Does not allocate: the hash of the name is computed once
+   * and only names with a matching hash are compared
+   *
+   * @param field:
    * The field name to locate a field within the set of fields
    *
    * @return Iterator to the location of the field, else
    * location to the end of the sequence
    */
-  template
-  <
-    typename F,
-    typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value>
-  >
-  Const_iterator find(F&& field) const noexcept;
+  Entry_iterator find(std::string_view field) const noexcept;
+
+  /**
+   * @brief Find the location of the first field with the specified
+   * identifier within the set of fields
+   *
+   * @param id:
+   * The identifier of the field
+   *
+   * @return Iterator to the location of the field, else
+   * location to the end of the sequence
+   */
+  Entry_iterator find(const Header_id id) const noexcept;
 
   /**
    * @brief Operator to stream the contents of the set of fields
@@ -333,16 +687,69 @@ private:
   friend std::ostream& operator << (std::ostream& output_device, const Header& header);
 }; //< class Header
 
+/**
+ * @brief This class is used to represent a header section that
+ * exceeds the limits of the {Header} it is added to
+ *
+ * It carries the status code to reject the message with
+ */
+class Header_limit_error : public std::runtime_error {
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param what:
+   * A description of the error
+   *
+   * @param code:
+   * The status code to respond with
+   */
+  explicit Header_limit_error(const std::string& what,
+                              const status_t code = Request_Header_Fields_Too_Large)
+    : runtime_error{what}
+    , code_{code}
+  {}
+
+  /**
+   * @brief Get the status code to respond with
+   *
+   * @return {Request_Header_Fields_Too_Large} or {URI_Too_Long}
+   */
+  status_t status_code() const noexcept
+  { return code_; }
+private:
+  status_t code_;
+}; //< class Header_limit_error
+
+/**
+ * @brief This class is used to represent a malformed field line
+ * within a header section
+ *
+ * A message holding one is answered with {Bad_Request}
+ */
+class Header_error : public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
 /**--v----------- Implementation Details -----------v--**/
 
 inline Header::Header() noexcept {
   set_limit(25);
 }
 
-inline Header::Header(const Limit limit) noexcept {
+inline Header::Header(const Limit limit, std::pmr::memory_resource* resource) noexcept
+  : fields_{resource}
+  , bytes_{resource}
+{
   set_limit(limit);
 }
 
+inline Header::Header(const Header_limits& limits, std::pmr::memory_resource* resource) noexcept
+  : fields_{resource}
+  , bytes_{resource}
+  , limits_{limits}
+{}
+
 template <typename T, typename>
 inline Header::Header(T&& header_data, const Limit limit)
   : Header {limit}
@@ -351,139 +758,159 @@ inline Header::Header(T&& header_data, const Limit limit)
 }
 
 inline void Header::set_limit(const Limit limit) noexcept {
-  fields_.reserve(limit);
+  limits_.fields = limit;
 }
 
 inline Limit Header::get_limit() const noexcept {
-  return fields_.capacity();
+  return limits_.fields;
 }
 
-template <typename Field, typename Value, typename>
-inline bool Header::add_field(Field&& field, Value&& value) {
-  if (field.empty()) return false;
+template <typename Name, typename Value, typename>
+inline bool Header::add_field(Name&& field, Value&& value) {
+  const std::string_view name {field};
+  if (name.empty() or name.size() > UINT16_MAX) return false;
   //-----------------------------------
-  if (size() < fields_.capacity()) {
-    fields_.emplace_back(std::forward<Field>(field), std::forward<Value>(value));
-    return true;
-  }
+  // The value may refer to a field of this header, which appending
+  // the name can move
+  std::string_view bytes {value};
+  const bool aliased = not bytes.empty() and bytes.data() >= bytes_.data()
+                       and bytes.data() < bytes_.data() + bytes_.size();
+  const std::size_t offset = aliased ? static_cast<std::size_t>(bytes.data() - bytes_.data()) : 0;
+  //-----------------------------------
+  auto& entry = append(name);
+  if (aliased) bytes = {bytes_.data() + offset, bytes.size()};
+  append_value(entry, bytes);
+  collect();
   //-----------------------------------
-  return false;
+  return true;
 }
 
 template <typename Data, typename>
 inline void Header::add_fields(Data&& data) {
-  if (data.empty()) return;
-  //-----------------------------------
-  auto iterator = data.cbegin();
-  auto sentinel = data.cend();
-  //-----------------------------------
-  std::string field;
-  std::string value;
-  field.reserve(24);
-  value.reserve(64);
-  //-----------------------------------
-  Limit limit {0};
-  int character = *iterator;
-  const int stop_char = std::char_traits<std::string::value_type>::eof();
-  //-----------------------------------
-  while (iterator not_eq sentinel
-         and character not_eq stop_char
-         and limit < fields_.capacity())
-  {
-    field.clear();
-    value.clear();
-    //-----------------------------------
-    while (iterator not_eq sentinel and isspace(character)) {
-      character = *++iterator;
+  const std::string_view bytes {data};
+  if (bytes.empty()) return;
+  //-----------------------------------
+  add_fields(bytes.data(), bytes.data() + bytes.size());
+}
+
+inline const char* Header::add_fields(const char* const begin, const char* const end) {
+  auto is_space = [](const char c) { return c == ' ' or c == '\t'; };
+  //-----------------------------------
+  Delimiter_scanner scanner {begin, end};
+  //-----------------------------------
+  // Locate the end of the line starting at {from}, skipping any ':'
+  auto line_end = [&scanner, end](const char* from) {
+    auto d = scanner.next(from);
+    while (d < end and *d == ':') d = scanner.next(d + 1);
+    return d;
+  };
+  //-----------------------------------
+  // Step over the line-ending at {eol}, which is CRLF or a bare LF
+  auto next_line = [end](const char* eol) {
+    if (eol < end and *eol == '\r') {
+      if (++eol < end and *eol not_eq '\n') throw Header_error {"Bare CR in header section"};
     }
+    if (eol < end and *eol == '\n') ++eol;
+    return eol;
+  };
+  //-----------------------------------
+  auto trim = [&is_space](const char*& first, const char*& last) {
+    while (first < last and is_space(*first))      ++first;
+    while (last > first and is_space(*(last - 1))) --last;
+  };
+  //-----------------------------------
+  const char* cursor = begin;
+  //-----------------------------------
+  while (cursor < end) {
+    const char* const line_begin = cursor;
+    auto delimiter = scanner.next(cursor);
     //-----------------------------------
-    while (iterator not_eq sentinel
-           and character not_eq stop_char
-           and character not_eq ':'
-           and not iscntrl(character)
-           and not isspace(character))
-    {
-      field += character;
-      character = *++iterator;
-    }
+    // An empty line ends the header section
+    if (delimiter == cursor and *delimiter not_eq ':') return next_line(delimiter);
     //-----------------------------------
-    while (iterator not_eq sentinel and isspace(character)) {
-      character = *++iterator;
+    if (delimiter == end or *delimiter not_eq ':') {
+      throw Header_error {"Invalid header field: " + std::string{cursor, delimiter}};
     }
     //-----------------------------------
-    if (character not_eq ':') return;
-    //-----------------------------------
-    if (iterator not_eq sentinel) character = *++iterator;
-    //-----------------------------------
-    while (iterator not_eq sentinel and isspace(character)) {
-      character = *++iterator;
+    const std::string_view name {cursor, static_cast<std::size_t>(delimiter - cursor)};
+    if (not is_field_name(name) or name.size() > UINT16_MAX) {
+      throw Header_error {"Invalid header field name: " + std::string{name}};
     }
     //-----------------------------------
-parse_value:
-    while (iterator not_eq sentinel
-           and character not_eq stop_char
-           and not iscntrl(character)
-           and character not_eq '\r'
-           and character not_eq '\n')
-    {
-      value += character;
-      character = *++iterator;
-    }
+    auto value_begin = delimiter + 1;
+    auto value_end   = line_end(value_begin);
+    cursor = next_line(value_end);
     //-----------------------------------
-    int lws_count {0};
+    // Lines are measured before anything is stored, so an overlong
+    // line is never buffered
+    std::size_t line = value_end - line_begin;
+    if (line > limits_.line) check_size(line, 0);
     //-----------------------------------
-    while (iterator not_eq sentinel
-           and (character == '\r' || character == '\n'))
-    {
-      character = *++iterator;
-      ++lws_count;
-    }
+    trim(value_begin, value_end);
     //-----------------------------------
-    if (lws_count == 3) break;
+    // The value is built in place in the new field
+    check_count();
+    check_size(line, name.size() + (value_end - value_begin));
+    auto& entry = append(name);
+    append_value(entry, {value_begin, static_cast<std::size_t>(value_end - value_begin)});
     //-----------------------------------
-    while (iterator not_eq sentinel and isspace(character)) {
-      character = *++iterator;
+    // Unfold continuation lines (obs-fold) into a single space
+    while (cursor < end and is_space(*cursor)) {
+      auto fold_begin = cursor;
+      auto fold_end   = line_end(fold_begin);
+      cursor = next_line(fold_end);
+      //-----------------------------------
+      line += fold_end - fold_begin;
+      if (line > limits_.line) check_size(line, 0);
       //-----------------------------------
-      if (iterator not_eq sentinel
-          and ((iterator + 1) not_eq sentinel)
-          and isspace(*(iterator + 1)))
-        continue;
+      trim(fold_begin, fold_end);
       //-----------------------------------
-      goto parse_value;
+      if (fold_begin == fold_end) continue;
+      //-----------------------------------
+      check_size(line, 1 + (fold_end - fold_begin));
+      append_value(entry, " ");
+      append_value(entry, {fold_begin, static_cast<std::size_t>(fold_end - fold_begin)});
     }
-    //-----------------------------------
-    add_field(field, value);
-    //-----------------------------------
-    ++limit;
-    //-----------------------------------
   }
+  //-----------------------------------
+  return end;
 }
 
-template <typename Field, typename Value, typename>
-inline bool Header::set_field(Field&& field, Value&& value) {
-  if (field.empty() || value.empty()) return false;
+template <typename Name, typename Value, typename>
+inline bool Header::set_field(Name&& field, Value&& value) {
+  if (std::string_view{field}.empty() || std::string_view{value}.empty()) return false;
   //-----------------------------------
   auto target = find(field);
   //-----------------------------------
   if (target not_eq fields_.end()) {
-    const_cast<std::string&>((*target).second) = std::forward<Value>(value);
+    assign_value(fields_[static_cast<std::size_t>(target - fields_.cbegin())], value);
     return true;
   }
-  else return add_field(std::forward<Field>(field), std::forward<Value>(value));
+  else return add_field(std::forward<Name>(field), std::forward<Value>(value));
+}
+
+template <typename Name, typename>
+inline std::string_view Header::get_value(Name&& field) const noexcept {
+  auto target = find(field);
+  //-----------------------------------
+  return (target not_eq fields_.end()) ? this->field(*target).value : std::string_view{};
 }
 
-template <typename Field, typename>
-inline const std::string& Header::get_value(Field&& field) const noexcept {
-  if (field.empty()) return field;
+inline std::string_view Header::get_value(const Header_id id) const noexcept {
+  auto target = find(id);
   //-----------------------------------
-  return find(std::forward<Field>(field))->second;
+  return (target not_eq fields_.end()) ? field(*target).value : std::string_view{};
 }
 
-template <typename Field, typename>
-inline bool Header::has_field(Field&& field) const noexcept {
-  if (field.empty()) return false;
+template <typename Name, typename>
+inline bool Header::has_field(Name&& field) const noexcept {
+  if (std::string_view{field}.empty()) return false;
   //-----------------------------------
-  return find(std::forward<Field>(field)) not_eq fields_.end();
+  return find(field) not_eq fields_.end();
+}
+
+inline bool Header::has_field(const Header_id id) const noexcept {
+  return find(id) not_eq fields_.end();
 }
 
 inline bool Header::is_empty() const noexcept {
@@ -494,44 +921,185 @@ inline Limit Header::size() const noexcept {
   return fields_.size();
 }
 
-template <typename Field, typename>
-inline void Header::erase(Field&& field) noexcept {
-  if (field.empty()) return;
+template <typename Name, typename>
+inline void Header::erase(Name&& field) noexcept {
+  if (std::string_view{field}.empty()) return;
   //-----------------------------------
-  auto target = find(std::forward<Field>(field));
+  auto target = find(field);
   //-----------------------------------
-  if (target not_eq fields_.end()) fields_.erase(target);
+  if (target not_eq fields_.end()) {
+    garbage_ += target->name_size + target->value_size;
+    fields_.erase(target);
+    index();
+  }
 }
 
 inline void Header::clear() noexcept {
   fields_.clear();
+  bytes_.clear();
+  garbage_ = 0;
+  slots_.fill(0);
+}
+
+inline void Header::check_count() const {
+  if (size() >= limits_.fields) {
+    throw Header_limit_error {"Header section exceeds " + std::to_string(limits_.fields) + " fields"};
+  }
+}
+
+inline void Header::check_size(const std::size_t line, const std::size_t added) const {
+  if (line > limits_.line) {
+    throw Header_limit_error {"Header field line exceeds " + std::to_string(limits_.line) + " bytes"};
+  }
+  //-----------------------------------
+  if (bytes_.size() - garbage_ + added > limits_.total) {
+    throw Header_limit_error {"Header section exceeds " + std::to_string(limits_.total) + " bytes"};
+  }
+}
+
+inline Header::Entry& Header::append(std::string_view name) {
+  // Start with room for a typical header section rather than
+  // growing one field at a time
+  if (fields_.capacity() == 0) fields_.reserve(std::min<Limit>(limits_.fields, 8));
+  //-----------------------------------
+  // The name may refer to a field of this header, which appending
+  // it can move, so it is only read before
+  const auto hash = field_hash(name);
+  const auto id   = header_fields::id(name);
+  const auto size = static_cast<uint16_t>(name.size());
+  //-----------------------------------
+  const auto offset = static_cast<uint32_t>(bytes_.size());
+  bytes_.append(name);
+  //-----------------------------------
+  fields_.push_back({offset, static_cast<uint32_t>(bytes_.size()), 0, hash, size, id});
+  index(fields_.size());
+  //-----------------------------------
+  return fields_.back();
+}
+
+inline void Header::append_value(Entry& entry, std::string_view bytes) {
+  bytes_.append(bytes);
+  entry.value_size += static_cast<uint32_t>(bytes.size());
+}
+
+inline void Header::assign_value(Entry& entry, std::string_view value) {
+  if (value.size() <= entry.value_size) {
+    std::memmove(&bytes_[entry.value_offset], value.data(), value.size());
+    garbage_ += entry.value_size - value.size();
+    entry.value_size = static_cast<uint32_t>(value.size());
+    return;
+  }
+  //-----------------------------------
+  garbage_ += entry.value_size;
+  const auto offset = static_cast<uint32_t>(bytes_.size());
+  bytes_.append(value);
+  entry.value_offset = offset;
+  entry.value_size   = static_cast<uint32_t>(value.size());
+  //-----------------------------------
+  collect();
+}
+
+inline void Header::collect() {
+  if (garbage_ <= bytes_.size() / 2) return;
+  //-----------------------------------
+  std::pmr::string bytes {resource()};
+  bytes.reserve(bytes_.size() - garbage_);
+  //-----------------------------------
+  for (auto& entry : fields_) {
+    const auto f = field(entry);
+    entry.name_offset  = static_cast<uint32_t>(bytes.size());
+    bytes.append(f.name);
+    entry.value_offset = static_cast<uint32_t>(bytes.size());
+    bytes.append(f.value);
+  }
+  //-----------------------------------
+  bytes_.swap(bytes);
+  garbage_ = 0;
+}
+
+inline void Header::index(const std::size_t position) noexcept {
+  const Header_id id = fields_[position - 1].id;
+  if (id == Header_id::Unknown or position > UINT16_MAX) return;
+  //-----------------------------------
+  auto& slot = slots_[static_cast<std::size_t>(id)];
+  if (slot == 0) slot = static_cast<uint16_t>(position);
 }
 
-inline static std::string string_to_lower_case(std::string s) {
-  std::transform(s.begin(), s.end(), s.begin(), ::tolower);
-  return s;
+inline void Header::index() noexcept {
+  slots_.fill(0);
+  //-----------------------------------
+  for (std::size_t i = fields_.size(); i > 0; --i) {
+    const Header_id id = fields_[i - 1].id;
+    if (id not_eq Header_id::Unknown and i <= UINT16_MAX) {
+      slots_[static_cast<std::size_t>(id)] = static_cast<uint16_t>(i);
+    }
+  }
 }
 
-template <typename Field, typename>
-inline Header::Const_iterator Header::find(Field&& field) const noexcept {
+inline Header::Entry_iterator Header::find(std::string_view field) const noexcept {
   if (field.empty()) return fields_.end();
   //-----------------------------------
+  const Header_id id = header_fields::id(field);
+  if (id not_eq Header_id::Unknown) return find(id);
+  //-----------------------------------
+  const uint32_t hash = field_hash(field);
+  //-----------------------------------
   return
-  std::find_if(fields_.begin(), fields_.end(), [&field](const auto& f) {
-    return string_to_lower_case(f.first) == string_to_lower_case(field);
+  std::find_if(fields_.begin(), fields_.end(), [this, field, hash](const auto& f) {
+    return f.hash == hash and iequals({bytes_.data() + f.name_offset, f.name_size}, field);
   });
 }
 
-inline std::string Header::to_string() const {
-  std::ostringstream header;
+inline Header::Entry_iterator Header::find(const Header_id id) const noexcept {
+  if (id == Header_id::Unknown) return fields_.end();
+  //-----------------------------------
+  const auto slot = slots_[static_cast<std::size_t>(id)];
+  //-----------------------------------
+  if (slot not_eq 0) return fields_.begin() + (slot - 1);
   //-----------------------------------
-  for (const auto& field : fields_) {
-    header << field.first << ": " << field.second << "\r\n";
+  // Fields past the reach of the slot table are only found by a scan
+  if (fields_.size() <= UINT16_MAX) return fields_.end();
+  //-----------------------------------
+  return
+  std::find_if(fields_.begin(), fields_.end(), [id](const auto& f) {
+    return f.id == id;
+  });
+}
+
+inline std::size_t Header::serialized_size() const noexcept {
+  std::size_t size {2};
+  //-----------------------------------
+  for (const auto& entry : fields_) {
+    size += entry.name_size + 2 + entry.value_size + 2;
+  }
+  //-----------------------------------
+  return size;
+}
+
+inline char* Header::serialize_into(char* out) const noexcept {
+  for (const auto& entry : fields_) {
+    const auto f = field(entry);
+    out = format::write(out, f.name);
+    out = format::write(out, ": ");
+    out = format::write(out, f.value);
+    out = format::write(out, "\r\n");
   }
   //-----------------------------------
-  header << "\r\n";
+  return format::write(out, "\r\n");
+}
+
+inline void Header::append_to(std::string& out) const {
+  const auto size = out.size();
+  out.resize(size + serialized_size());
+  serialize_into(&out[size]);
+}
+
+inline std::string Header::to_string() const {
+  std::string header;
+  //-----------------------------------
+  append_to(header);
   //-----------------------------------
-  return header.str();
+  return header;
 }
 
 inline Header::operator std::string () const {
@@ -18,71 +18,229 @@
 #ifndef HTTP_HEADER_FIELDS_HPP
 #define HTTP_HEADER_FIELDS_HPP
 
-#include <string>
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#include "ascii.hpp"
 
 namespace http {
 namespace header_fields {
 //------------------------------------------------
-using Field = const std::string;
+using Field = std::string_view;
+//------------------------------------------------
+//------------------------------------------------
+namespace General {
+inline constexpr Field Cache_Control       {"Cache-Control"};
+inline constexpr Field Date                {"Date"};
+inline constexpr Field Pragma              {"Pragma"};
+inline constexpr Field Trailer             {"Trailer"};
+inline constexpr Field Transfer_Encoding   {"Transfer-Encoding"};
+inline constexpr Field Via                 {"Via"};
+inline constexpr Field Warning             {"Warning"};
+} //< namespace General
 //------------------------------------------------
 //------------------------------------------------
 namespace Request {
-Field Accept              {"Accept"};
-Field Accept_Charset      {"Accept-Charset"};
-Field Accept_Encoding     {"Accept-Encoding"};
-Field Accept_Language     {"Accept-Language"};
-Field Authorization       {"Authorization"};
-Field Connection          {"Connection"};
-Field Cookie              {"Cookie"};
-Field Expect              {"Expect"};
-Field From                {"From"};
-Field Host                {"Host"};
-Field HTTP2_Settings      {"HTTP2-Settings"};
-Field If_Match            {"If-Match"};
-Field If_Modified_Since   {"If-Modified-Since"};
-Field If_None_Match       {"If-None-Match"};
-Field If_Range            {"If-Range"};
-Field If_Unmodified_Since {"If-Unmodified-Since"};
-Field Max_Forwards        {"Max-Forwards"};
-Field Proxy_Authorization {"Proxy-Authorization"};
-Field Range               {"Range"};
-Field Referer             {"Referer"};
-Field TE                  {"TE"};
-Field Upgrade             {"Upgrade"};
-Field User_Agent          {"User-Agent"};
+inline constexpr Field Accept              {"Accept"};
+inline constexpr Field Accept_Charset      {"Accept-Charset"};
+inline constexpr Field Accept_Encoding     {"Accept-Encoding"};
+inline constexpr Field Accept_Language     {"Accept-Language"};
+inline constexpr Field Authorization       {"Authorization"};
+inline constexpr Field Connection          {"Connection"};
+inline constexpr Field Cookie              {"Cookie"};
+inline constexpr Field Expect              {"Expect"};
+inline constexpr Field From                {"From"};
+inline constexpr Field Host                {"Host"};
+inline constexpr Field HTTP2_Settings      {"HTTP2-Settings"};
+inline constexpr Field If_Match            {"If-Match"};
+inline constexpr Field If_Modified_Since   {"If-Modified-Since"};
+inline constexpr Field If_None_Match       {"If-None-Match"};
+inline constexpr Field If_Range            {"If-Range"};
+inline constexpr Field If_Unmodified_Since {"If-Unmodified-Since"};
+inline constexpr Field Max_Forwards        {"Max-Forwards"};
+inline constexpr Field Proxy_Authorization {"Proxy-Authorization"};
+inline constexpr Field Range               {"Range"};
+inline constexpr Field Referer             {"Referer"};
+inline constexpr Field TE                  {"TE"};
+inline constexpr Field Upgrade             {"Upgrade"};
+inline constexpr Field User_Agent          {"User-Agent"};
 } //< namespace Request
 //------------------------------------------------
 //------------------------------------------------
 namespace Response {
-Field Accept_Ranges       {"Accept-Ranges"};
-Field Age                 {"Age"};
-Field Connection          {"Connection"};
-Field ETag                {"ETag"};
-Field Location            {"Location"};
-Field Proxy_Authenticate  {"Proxy-Authenticate"};
-Field Retry_After         {"Retry-After"};
-Field Server              {"Server"};
-Field Set_Cookie          {"Set-Cookie"};
-Field Upgrade             {"Upgrade"};
-Field Vary                {"Vary"};
-Field WWW_Authenticate    {"WWW-Authenticate"};
+inline constexpr Field Accept_Ranges       {"Accept-Ranges"};
+inline constexpr Field Age                 {"Age"};
+inline constexpr Field Connection          {"Connection"};
+inline constexpr Field ETag                {"ETag"};
+inline constexpr Field Location            {"Location"};
+inline constexpr Field Proxy_Authenticate  {"Proxy-Authenticate"};
+inline constexpr Field Retry_After         {"Retry-After"};
+inline constexpr Field Server              {"Server"};
+inline constexpr Field Set_Cookie          {"Set-Cookie"};
+inline constexpr Field Upgrade             {"Upgrade"};
+inline constexpr Field Vary                {"Vary"};
+inline constexpr Field WWW_Authenticate    {"WWW-Authenticate"};
 } //< namespace Response
 //------------------------------------------------
 //------------------------------------------------
 namespace Entity {
-Field Allow               {"Allow"};
-Field Content_Encoding    {"Content-Encoding"};
-Field Content_Language    {"Content-Language"};
-Field Content_Length      {"Content-Length"};
-Field Content_Location    {"Content-Location"};
-Field Content_MD5         {"Content-MD5"};
-Field Content_Range       {"Content-Range"};
-Field Content_Type        {"Content-Type"};
-Field Expires             {"Expires"};
-Field Last_Modified       {"Last-Modified"};
+inline constexpr Field Allow               {"Allow"};
+inline constexpr Field Content_Encoding    {"Content-Encoding"};
+inline constexpr Field Content_Language    {"Content-Language"};
+inline constexpr Field Content_Length      {"Content-Length"};
+inline constexpr Field Content_Location    {"Content-Location"};
+inline constexpr Field Content_MD5         {"Content-MD5"};
+inline constexpr Field Content_Range       {"Content-Range"};
+inline constexpr Field Content_Type        {"Content-Type"};
+inline constexpr Field Expires             {"Expires"};
+inline constexpr Field Last_Modified       {"Last-Modified"};
 } //< namespace Entity
 //------------------------------------------------
 //------------------------------------------------
+} //< namespace header_fields
+
+/**
+ * @brief Compile-time identifiers of the standard field names
+ * listed in {header_fields}
+ *
+ * Names that appear in more than one group (Connection, Upgrade)
+ * have a single identifier
+ */
+enum class Header_id : uint8_t {
+  // General
+  Cache_Control, Date, Pragma, Trailer, Transfer_Encoding, Via, Warning,
+  // Request
+  Accept, Accept_Charset, Accept_Encoding, Accept_Language, Authorization,
+  Connection, Cookie, Expect, From, Host, HTTP2_Settings, If_Match,
+  If_Modified_Since, If_None_Match, If_Range, If_Unmodified_Since,
+  Max_Forwards, Proxy_Authorization, Range, Referer, TE, Upgrade, User_Agent,
+  // Response
+  Accept_Ranges, Age, ETag, Location, Proxy_Authenticate, Retry_After,
+  Server, Set_Cookie, Vary, WWW_Authenticate,
+  // Entity
+  Allow, Content_Encoding, Content_Language, Content_Length, Content_Location,
+  Content_MD5, Content_Range, Content_Type, Expires, Last_Modified,
+  //-----------------------------------
+  Unknown
+}; //< enum class Header_id
+
+namespace header_fields {
+
+/**
+ * @brief Number of well-known field names
+ */
+constexpr std::size_t count {static_cast<std::size_t>(Header_id::Unknown)};
+
+/**
+ * @brief The well-known field names indexed by {Header_id}
+ */
+inline constexpr std::array<Field, count> names {{
+  General::Cache_Control, General::Date, General::Pragma, General::Trailer,
+  General::Transfer_Encoding, General::Via, General::Warning,
+  Request::Accept, Request::Accept_Charset, Request::Accept_Encoding,
+  Request::Accept_Language, Request::Authorization, Request::Connection,
+  Request::Cookie, Request::Expect, Request::From, Request::Host,
+  Request::HTTP2_Settings, Request::If_Match, Request::If_Modified_Since,
+  Request::If_None_Match, Request::If_Range, Request::If_Unmodified_Since,
+  Request::Max_Forwards, Request::Proxy_Authorization, Request::Range,
+  Request::Referer, Request::TE, Request::Upgrade, Request::User_Agent,
+  Response::Accept_Ranges, Response::Age, Response::ETag, Response::Location,
+  Response::Proxy_Authenticate, Response::Retry_After, Response::Server,
+  Response::Set_Cookie, Response::Vary, Response::WWW_Authenticate,
+  Entity::Allow, Entity::Content_Encoding, Entity::Content_Language,
+  Entity::Content_Length, Entity::Content_Location, Entity::Content_MD5,
+  Entity::Content_Range, Entity::Content_Type, Entity::Expires,
+  Entity::Last_Modified
+}};
+
+/**
+ * @brief Number of slots in the perfect hash table
+ */
+constexpr std::size_t id_slots {128};
+
+/**
+ * @brief Hash a non-empty field name into a slot of the perfect
+ * hash table
+ *
+ * Mixes the length with the first, middle and last bytes (case
+ * folded); the multipliers were chosen so that no two well-known
+ * names share a slot, which is checked at compile-time below
+ *
+ * @param name:
+ * The field name to hash
+ *
+ * @return The slot for the field name
+ */
+constexpr std::size_t id_slot(std::string_view name) noexcept {
+  auto byte = [name](const std::size_t i) {
+    return static_cast<std::size_t>(static_cast<unsigned char>(to_lower(name[i])));
+  };
+  //-----------------------------------
+  return (name.size() * 29 + byte(0) * 36 + byte(name.size() - 1) * 23 + byte(name.size() / 2))
+         & (id_slots - 1);
+}
+
+/**
+ * @brief The perfect hash table from slot to {Header_id}
+ */
+struct Id_table {
+  std::array<Header_id, id_slots> slots {};
+  bool perfect {true};
+};
+
+constexpr Id_table make_id_table() noexcept {
+  Id_table table;
+  //-----------------------------------
+  for (auto& slot : table.slots) slot = Header_id::Unknown;
+  //-----------------------------------
+  for (std::size_t i = 0; i < count; ++i) {
+    auto& slot = table.slots[id_slot(names[i])];
+    if (slot not_eq Header_id::Unknown) table.perfect = false;
+    slot = static_cast<Header_id>(i);
+  }
+  //-----------------------------------
+  return table;
+}
+
+inline constexpr Id_table id_table {make_id_table()};
+
+static_assert(id_table.perfect, "Well-known field names collide in the perfect hash table");
+
+/**
+ * @brief Map a field name onto its {Header_id}
+ *
+ * One hash, one table load and one case-insensitive compare
+ *
+ * @param name:
+ * The field name (case-insensitive)
+ *
+ * @return The identifier of the field name, or {Header_id::Unknown}
+ * if it is not a well-known name
+ */
+constexpr Header_id id(std::string_view name) noexcept {
+  if (name.empty()) return Header_id::Unknown;
+  //-----------------------------------
+  const Header_id candidate = id_table.slots[id_slot(name)];
+  //-----------------------------------
+  return (candidate not_eq Header_id::Unknown
+          and iequals(names[static_cast<std::size_t>(candidate)], name))
+         ? candidate : Header_id::Unknown;
+}
+
+/**
+ * @brief Get the canonical name of a well-known field
+ *
+ * @param id:
+ * The identifier of the field
+ *
+ * @return The name of the field, or an empty view for
+ * {Header_id::Unknown}
+ */
+constexpr std::string_view name(const Header_id id) noexcept {
+  return (id == Header_id::Unknown) ? std::string_view{} : names[static_cast<std::size_t>(id)];
+}
+
 } //< namespace header_fields
 } //< namespace http
 
@@ -18,24 +18,49 @@
 #ifndef HTTP_MESSAGE_HPP
 #define HTTP_MESSAGE_HPP
 
-#include <sstream>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <algorithm>
+#include <memory_resource>
 
+#include "body.hpp"
 #include "time.hpp"
 #include "header.hpp"
+#include "chunked.hpp"
 
 namespace http {
 
+/**
+ * @brief This class is used to represent an error that occurred
+ * from within the operations of class Message
+ *
+ * A message rejected for its framing is answered with {Bad_Request}
+ */
+class Message_error : public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
 /**
  * @brief This class is used as a generic base class for an
  * HTTP message
+ *
+ * The {Content-Length} field is derived from the entity when
+ * the message is serialized, so changing the entity never
+ * touches the header section. A {Content-Length} field added
+ * to the header section overrides the derived one. An entity of
+ * unknown length without either framing field is written in the
+ * chunked transfer coding, with a derived {Transfer-Encoding}, and
+ * so is any entity when a {Transfer-Encoding} field added to the
+ * header section ends with chunked
  */
 class Message {
 private:
   //----------------------------------------
   // Internal class type aliases
   using HSize        = Limit;
-  using HValue       = const std::string&;
-  using Message_Body = std::string;
+  using HValue       = std::string_view;
+  using Message_Body = Body;
   //----------------------------------------
 public:
   /**
@@ -50,8 +75,14 @@ public:
    * @param limit:
    * Maximum number of fields that can be added to the
    * message             
+   *
+   * @param resource:
+   * The memory resource the header section and body are
+   * allocated from, which must outlive this object, e.g. an
+   * arena that is released once the message is done with
    */
-  explicit Message(const Limit limit) noexcept;
+  explicit Message(const Limit limit,
+                   std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
 
   /**
    * @brief Default copy constructor
@@ -80,9 +111,12 @@ public:
 
   /**
    * @brief Set the maximum number of fields that
-   * can be added to the header section for an instance
+   * can be parsed into the header section for an instance
    * of this class
    *
+   * Like all the header limits it bounds what a peer can send,
+   * so fields added to build a message are not counted against it
+   *
    * @param limit:
    * The maximum number of fields that can be added to
    * the header section
@@ -99,6 +133,34 @@ public:
    */
   Limit get_header_limit() const noexcept;
 
+  /**
+   * @brief Set all caps on the size of the header section
+   * for an instance of this class
+   *
+   * @param limits:
+   * The caps on the number of fields, the length of a line
+   * and the bytes of all fields
+   *
+   * @return The object that invoked this method
+   */
+  Message& set_header_limits(const Header_limits& limits) noexcept;
+
+  /**
+   * @brief Get the caps on the size of the header section
+   * for this message
+   *
+   * @return The caps on the size of the header section
+   */
+  const Header_limits& get_header_limits() const noexcept;
+
+  /**
+   * @brief Get the memory resource the header section and
+   * body are allocated from
+   *
+   * @return The memory resource of this message
+   */
+  std::pmr::memory_resource* resource() const noexcept;
+
   /**
    * @brief Add a new field to the current set of
    * headers
@@ -115,12 +177,10 @@ public:
   <
     typename F, typename V,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value and
-                std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<V>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value and
+                std::is_convertible
+               <V, std::string_view>::value>
   >
   Message& add_header(F&& field, V&& value);
 
@@ -143,18 +203,35 @@ public:
   <
     typename D,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<D>>>::value>
+               <std::is_convertible
+               <D, std::string_view>::value>
   >
   Message& add_headers(D&& data);
 
+  /**
+   * @brief Add a set of fields to the header section of
+   * the message from a range of bytes, stopping at the
+   * empty line that ends the header section
+   *
+   * @param begin:
+   * The start of the range
+   *
+   * @param end:
+   * The end of the range
+   *
+   * @return Pointer to the first byte after the header
+   * section
+   *
+   * @note Throws {Message_error} at a malformed field line and
+   * {Header_limit_error} if the fields exceed the header limits
+   */
+  const char* add_headers(const char* const begin, const char* const end);
+
   /**
    * @brief Change the value of the specified field
    *
    * If the field is absent from the message it
-   * will be added with the associated value if
-   * within capacity of maximum allowable limit
+   * will be added with the associated value
    *
    * @tparam F field:
    * The name of the field
@@ -168,12 +245,10 @@ public:
   <
     typename F, typename V,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value and
-                std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<V>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value and
+                std::is_convertible
+               <V, std::string_view>::value>
   >
   Message& set_header(F&& field, V&& value);
 
@@ -185,6 +260,19 @@ public:
    */
   const Header& get_header() const noexcept;
 
+  /**
+   * @brief Get a read-only reference to the trailer fields
+   * received after a chunked entity
+   *
+   * Trailer fields are kept apart from the header section, as
+   * merging them could add fields after the header section was
+   * checked (RFC 7230 §4.1.2). They go with the entity, so replacing
+   * or clearing the entity clears them
+   *
+   * @return The trailer fields of this message
+   */
+  const Header& get_trailers() const noexcept;
+
   /**
    * @brief Get the value associated with the
    * specified field name
@@ -201,12 +289,23 @@ public:
   <
     typename F,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value>
   >
   HValue header_value(F&& field) const noexcept;
 
+  /**
+   * @brief Get the value associated with a well-known
+   * field in O(1)
+   *
+   * @param id:
+   * The identifier of the field
+   *
+   * @return The value associated with the field, or an
+   * empty string if absent
+   */
+  HValue header_value(const Header_id id) const noexcept;
+
   /**
    * @brief Check if the specified field is within
    * this message
@@ -220,12 +319,22 @@ public:
   <
     typename F,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value>
   >
   bool has_header(F&& field) const noexcept;
 
+  /**
+   * @brief Check if a well-known field is within this
+   * message in O(1)
+   *
+   * @param id:
+   * The identifier of the field
+   *
+   * @return true is present, false otherwise
+   */
+  bool has_header(const Header_id id) const noexcept;
+
   /**
    * @brief Remove the specified field from this
    * message
@@ -239,9 +348,8 @@ public:
   <
     typename F,
     typename = std::enable_if_t
-               <std::is_same
-               <std::string, std::remove_const_t
-               <std::remove_reference_t<F>>>::value>
+               <std::is_convertible
+               <F, std::string_view>::value>
   >
   Message& erase_header(F&& field) noexcept;
 
@@ -270,9 +378,22 @@ public:
    */
   HSize header_size() const noexcept;
 
+  /**
+   * @brief Get the length of the entity as it is sent in
+   * the {Content-Length} field
+   *
+   * @return The length, or {Body::unknown_size} if no field is
+   * sent or the field carries a value that is not a length
+   */
+  std::size_t content_length() const noexcept;
+
   /**
    * @brief Add an entity to the message
    *
+   * A {Content-Length} field in the header section is dropped, as
+   * it would no longer match; the length is derived again when the
+   * message is serialized
+   *
    * @tparam E message_body:
    * The entity to be sent with the message
    *
@@ -291,6 +412,10 @@ public:
   /**
    * @brief Append data to the entity of the message
    *
+   * A {Content-Length} field in the header section is dropped, as
+   * it would no longer match; the length is derived again when the
+   * message is serialized
+   *
    * @tparam D data:
    * The data to append to the entity of the message
    *
@@ -307,16 +432,41 @@ public:
   Message& append_body(D&& data);
 
   /**
-   * @brief Get a read-only reference to the entity in
+   * @brief Get a read-only view of the entity in
    * this the message
    *
-   * @return A read-only reference to the entity in
-   * this the message
+   * @return A read-only view of the entity in
+   * this the message, empty unless it is held in
+   * one piece, see {body}
+   */
+  std::string_view get_body() const noexcept;
+
+  /**
+   * @brief Get the entity of this message in whatever
+   * form it is held
+   *
+   * @return The entity of this message
+   */
+  const Body& body() const noexcept;
+
+  /**
+   * @brief Replace the entity of this message, e.g. with
+   * a rope, a file region or a generator
+   *
+   * A {Content-Length} field in the header section is dropped, as
+   * it would no longer match; the length is derived again when the
+   * message is serialized
+   *
+   * @param body:
+   * The new entity
+   *
+   * @return The object that invoked this method
    */
-  const Message_Body& get_body() const noexcept;
+  Message& set_body(Body body);
 
   /**
-   * @brief Remove the entity from the message
+   * @brief Remove the entity from the message along with
+   * any {Content-Length} field
    *
    * @return The object that invoked this method
    */
@@ -330,6 +480,45 @@ public:
    */
   virtual Message& reset() noexcept;
 
+  /**
+   * @brief Get the number of bytes written by {serialize_into}
+   *
+   * @return The exact serialized size of the message, including
+   * the chunk framing of a chunked entity, which does not count a
+   * generated entity of unknown length
+   */
+  virtual std::size_t serialized_size() const;
+
+  /**
+   * @brief Write the message in a single pass
+   *
+   * @param out:
+   * Where to write, with room for {serialized_size()} bytes
+   *
+   * @return Pointer past the last byte written
+   *
+   * @note Throws {Body_error} if the entity has no known size
+   */
+  virtual char* serialize_into(char* out) const;
+
+  /**
+   * @brief Write the message piece by piece, handing each
+   * part of the entity over in the form it is held in
+   *
+   * @param out:
+   * Where to write
+   */
+  virtual void write_to(Writer& out) const;
+
+  /**
+   * @brief Append the message to a string, growing it
+   * at most once
+   *
+   * @param out:
+   * The string to append to
+   */
+  void append_to(std::string& out) const;
+
   /**
    * @brief Get a string representation of this
    * class
@@ -343,19 +532,196 @@ public:
    * into string form
    */
   operator std::string () const;
+protected:
+  /**
+   * @brief Get the number of bytes written by {serialize_head_into}
+   *
+   * @return The size of the header section including the
+   * derived framing field
+   */
+  std::size_t head_size() const noexcept;
+
+  /**
+   * @brief Write the header section, ending with the derived
+   * {Content-Length} or {Transfer-Encoding} field unless the header
+   * section frames the entity itself
+   *
+   * @param out:
+   * Where to write, with room for {head_size()} bytes
+   *
+   * @return Pointer past the last byte written
+   */
+  char* serialize_head_into(char* out) const noexcept;
+
+  /**
+   * @brief Write the entity as {serialize_head_into} frames it
+   *
+   * @param out:
+   * Where to write
+   */
+  void write_body_to(Writer& out) const;
+
+  /**
+   * @brief Check if the entity is sent in the chunked transfer
+   * coding, as a derived or an explicit {Transfer-Encoding} field
+   * whose final coding is chunked asks for
+   *
+   * @return true if the entity is to be chunk-encoded, false otherwise
+   */
+  bool sends_chunked() const noexcept;
+
+  /**
+   * @brief Offset returned by {add_body_from} when the bytes
+   * end before the entity does
+   */
+  static constexpr std::size_t incomplete {SIZE_MAX};
+
+  /**
+   * @brief Progress through an entity received in pieces, kept
+   * between calls to {add_body_from} so that each byte of it is
+   * only taken once
+   */
+  struct Body_progress {
+    std::size_t     taken {0}; //< Bytes of the entity taken so far
+    Chunked_decoder decoder;   //< Decoder of a chunked entity
+
+    /**
+     * @brief Prepare for the entity of the next message
+     */
+    void reset() noexcept
+    { taken = 0; decoder.reset(); }
+  };
+
+  /**
+   * @brief Add the bytes of an incoming message that follow
+   * its header section as the entity of this message, delimited
+   * as RFC 7230 §3.3.3 describes
+   *
+   * The entity is copied out in one piece into the storage of
+   * the current entity. A chunked entity is decoded on the way,
+   * its trailer fields are kept apart, see {get_trailers}, and
+   * the chunked coding is dropped from {Transfer-Encoding}. An
+   * entity with a {Content-Length} field takes exactly that many
+   * bytes. Without either field the entity runs to the end of the
+   * bytes or is empty, as {to_end} says
+   *
+   * @param message:
+   * The character stream of data
+   *
+   * @param start_of_body:
+   * Offset of the entity within the message
+   *
+   * @param to_end:
+   * Whether an entity without framing fields runs to the end of
+   * {message}, which holds for a response received whole but never
+   * for a request
+   *
+   * @return Offset past the entity within {message}, or {incomplete}
+   * if the bytes end before the entity does
+   *
+   * @note Throws {Message_error} if the framing fields are invalid
+   * or conflict, and {Chunked_error} if a chunked entity is malformed
+   */
+  std::size_t add_body_from(std::string_view message, const std::size_t start_of_body, const bool to_end);
+
+  /**
+   * @brief Add the entity of an incoming message received in
+   * pieces, resuming where an earlier call left off
+   *
+   * Each call is given the bytes of the message received so far,
+   * the bytes of earlier calls followed by those that arrived since;
+   * only the bytes not taken yet are added to the entity
+   *
+   * @param message:
+   * The character stream of data received so far
+   *
+   * @param start_of_body:
+   * Offset of the entity within the message
+   *
+   * @param to_end:
+   * As for the one-shot overload
+   *
+   * @param progress:
+   * Progress through the entity, reset before the first call
+   *
+   * @return As for the one-shot overload
+   *
+   * @note Throws as the one-shot overload does
+   */
+  std::size_t add_body_from(std::string_view message, const std::size_t start_of_body, const bool to_end,
+                            Body_progress& progress);
+
+  /**
+   * @brief Ensure that a message received whole holds all of
+   * its entity
+   *
+   * @param end:
+   * The offset returned by {add_body_from}
+   *
+   * @note Throws {Chunked_error} if a chunked entity is incomplete,
+   * and {Message_error} if fewer bytes than {Content-Length} says
+   * were received
+   */
+  void check_complete(const std::size_t end) const;
 private:
   //------------------------------
   // Class data members
   Header       header_fields_;
+  Header       trailer_fields_;
   Message_Body message_body_;
   //------------------------------
+
+  /**
+   * @brief Get the length to send in a derived {Content-Length}
+   * field
+   *
+   * @return The length of the entity, or 0 if no field is to be
+   * derived: the header section has one or a {Transfer-Encoding},
+   * the entity is empty or its length is unknown
+   */
+  std::size_t derived_length() const noexcept;
+
+  /**
+   * @brief Check if the entity is to be sent in the chunked
+   * transfer coding with a derived {Transfer-Encoding} field
+   *
+   * @return true if the length of the entity is unknown and the
+   * header section has no framing field, false otherwise
+   */
+  bool derives_chunked() const noexcept;
+
+  /**
+   * @brief Drop an explicit {Content-Length} field once the
+   * entity changes
+   */
+  void drop_content_length() noexcept;
+
+  /**
+   * @brief Parse the value of a {Content-Length} field
+   *
+   * @return The length, or {Body::unknown_size} if the value
+   * is not a decimal number of at most 18 digits
+   */
+  static std::size_t parse_length(std::string_view value) noexcept;
+
+  /**
+   * @brief Get the length that the {Content-Length} fields of a
+   * received message agree on
+   *
+   * @return The length, or {Body::unknown_size} if there are none
+   *
+   * @note Throws {Message_error} if a value is invalid or the
+   * values differ
+   */
+  std::size_t framed_length() const;
 }; //< class Message
 
 /**--v----------- Implementation Details -----------v--**/
 
-inline Message::Message(const Limit limit) noexcept:
-  header_fields_{limit},
-  message_body_{}
+inline Message::Message(const Limit limit, std::pmr::memory_resource* resource) noexcept:
+  header_fields_{limit, resource},
+  trailer_fields_{limit, resource},
+  message_body_{resource}
 {}
 
 inline Message& Message::set_header_limit(const Limit limit) noexcept {
@@ -367,6 +733,19 @@ inline Limit Message::get_header_limit() const noexcept {
   return header_fields_.get_limit();
 }
 
+inline Message& Message::set_header_limits(const Header_limits& limits) noexcept {
+  header_fields_.set_limits(limits);
+  return *this;
+}
+
+inline const Header_limits& Message::get_header_limits() const noexcept {
+  return header_fields_.get_limits();
+}
+
+inline std::pmr::memory_resource* Message::resource() const noexcept {
+  return header_fields_.resource();
+}
+
 template <typename Field, typename Value, typename>
 inline Message& Message::add_header(Field&& field, Value&& value) {
   header_fields_.add_field(std::forward<Field>(field), std::forward<Value>(value));
@@ -379,6 +758,14 @@ inline Message& Message::add_headers(Data&& data) {
   return *this;
 }
 
+inline const char* Message::add_headers(const char* const begin, const char* const end) {
+  try {
+    return header_fields_.add_fields(begin, end);
+  } catch (const Header_error& error) {
+    throw Message_error {error.what()};
+  }
+}
+
 template <typename Field, typename Value, typename>
 inline Message& Message::set_header(Field&& field, Value&& value) {
   header_fields_.set_field(std::forward<Field>(field), std::forward<Value>(value));
@@ -389,16 +776,28 @@ inline const Header& Message::get_header() const noexcept {
   return header_fields_;
 }
 
+inline const Header& Message::get_trailers() const noexcept {
+  return trailer_fields_;
+}
+
 template <typename Field, typename>
 inline Message::HValue Message::header_value(Field&& field) const noexcept {
   return header_fields_.get_value(std::forward<Field>(field));
 }
 
+inline Message::HValue Message::header_value(const Header_id id) const noexcept {
+  return header_fields_.get_value(id);
+}
+
 template <typename Field, typename>
 inline bool Message::has_header(Field&& field) const noexcept {
   return header_fields_.has_field(std::forward<Field>(field));
 }
 
+inline bool Message::has_header(const Header_id id) const noexcept {
+  return header_fields_.has_field(id);
+}
+
 template <typename Field, typename>
 inline Message& Message::erase_header(Field&& field) noexcept {
   header_fields_.erase(std::forward<Field>(field));
@@ -422,28 +821,214 @@ template<typename Entity, typename>
 inline Message& Message::add_body(Entity&& message_body) {
   if (message_body.empty()) return *this;
   //-----------------------------------
-  message_body_ = std::forward<Entity>(message_body);
+  message_body_.assign(message_body);
+  trailer_fields_.clear();
+  drop_content_length();
   //-----------------------------------
-  return add_header(header_fields::Entity::Content_Length,
-                    std::to_string(message_body_.size()));
+  return *this;
 }
 
 template<typename Data, typename>
 inline Message& Message::append_body(Data&& data) {
   if (data.empty()) return *this;
   //-----------------------------------
-  message_body_.insert(message_body_.cend(), data.cbegin(), data.cend());
+  message_body_.append(data);
+  drop_content_length();
+  //-----------------------------------
+  return *this;
+}
+
+inline std::size_t Message::add_body_from(std::string_view message, const std::size_t start_of_body, const bool to_end) {
+  Body_progress progress;
+  return add_body_from(message, start_of_body, to_end, progress);
+}
+
+inline std::size_t Message::add_body_from(std::string_view message, const std::size_t start_of_body, const bool to_end,
+                                          Body_progress& progress)
+{
+  const auto body = (start_of_body < message.size()) ? message.substr(start_of_body) : std::string_view{};
+  const auto next = body.substr(std::min(progress.taken, body.size()));
+  const bool first_piece = (progress.taken == 0);
+  //-----------------------------------
+  const bool has_length   = header_fields_.has_field(Header_id::Content_Length);
+  const bool has_encoding = header_fields_.has_field(Header_id::Transfer_Encoding);
+  //-----------------------------------
+  // A message with both is how requests are smuggled past proxies
+  if (has_length and has_encoding) throw Message_error {"Both Transfer-Encoding and Content-Length"};
+  //-----------------------------------
+  if (has_length) {
+    const auto length = framed_length();
+    const auto size   = std::min(length, body.size());
+    //-----------------------------------
+    const auto piece = next.substr(0, size - std::min(progress.taken, size));
+    if (first_piece) message_body_.assign(piece);
+    else message_body_.append(piece);
+    progress.taken = size;
+    //-----------------------------------
+    return (size < length) ? incomplete : start_of_body + length;
+  }
+  //-----------------------------------
+  if (not has_encoding) {
+    if (not to_end) return start_of_body;
+    if (not body.empty()) message_body_.assign(body);
+    return start_of_body + body.size();
+  }
   //-----------------------------------
-  return set_header(header_fields::Entity::Content_Length,
-                    std::to_string(message_body_.size()));
+  // Without chunked as the final coding only the end of the
+  // bytes can delimit the entity
+  if (not is_chunked(header_value(Header_id::Transfer_Encoding))) {
+    if (not to_end) throw Message_error {"Unsupported Transfer-Encoding"};
+    if (not body.empty()) message_body_.assign(body);
+    return start_of_body + body.size();
+  }
+  //-----------------------------------
+  // Decode the entity as RFC 7230 §4.1.3 describes
+  auto& decoder = progress.decoder;
+  if (first_piece) {
+    message_body_.assign({});
+    trailer_fields_.clear();
+  }
+  decoder.feed(next.data(), next.size(), [this](std::string_view bytes) {
+    message_body_.append(bytes);
+  });
+  progress.taken += decoder.consumed();
+  //-----------------------------------
+  if (decoder.status() not_eq Chunked_decoder::Status::Complete) return incomplete;
+  //-----------------------------------
+  if (not decoder.trailers().is_empty()) trailer_fields_ = decoder.trailers();
+  //-----------------------------------
+  // Drop the chunked coding, which is the final one
+  const auto codings = header_value(Header_id::Transfer_Encoding);
+  const auto comma   = codings.rfind(',');
+  const auto last    = (comma == std::string_view::npos or comma == 0)
+                       ? std::string_view::npos : codings.find_last_not_of(" \t,", comma);
+  //-----------------------------------
+  if (last == std::string_view::npos) erase_header(header_fields::General::Transfer_Encoding);
+  else set_header(header_fields::General::Transfer_Encoding, std::string{codings.substr(0, last + 1)});
+  //-----------------------------------
+  return start_of_body + progress.taken;
+}
+
+inline void Message::check_complete(const std::size_t end) const {
+  if (end not_eq incomplete) return;
+  //-----------------------------------
+  if (header_fields_.has_field(Header_id::Transfer_Encoding)) {
+    throw Chunked_error {"Incomplete chunked body"};
+  }
+  throw Message_error {"Body shorter than its Content-Length"};
+}
+
+inline std::string_view Message::get_body() const noexcept {
+  return message_body_.view();
 }
 
-inline const Message::Message_Body& Message::get_body() const noexcept {
+inline const Body& Message::body() const noexcept {
   return message_body_;
 }
 
+inline Message& Message::set_body(Body body) {
+  message_body_ = std::move(body);
+  trailer_fields_.clear();
+  drop_content_length();
+  return *this;
+}
+
+inline std::size_t Message::content_length() const noexcept {
+  if (not header_fields_.has_field(Header_id::Content_Length)) {
+    const auto length = derived_length();
+    return (length == 0) ? Body::unknown_size : length;
+  }
+  //-----------------------------------
+  return parse_length(header_fields_.get_value(Header_id::Content_Length));
+}
+
+inline std::size_t Message::parse_length(std::string_view value) noexcept {
+  if (value.empty() or value.size() > 18) return Body::unknown_size;
+  //-----------------------------------
+  std::size_t length {0};
+  for (const char c : value) {
+    if (c < '0' or c > '9') return Body::unknown_size;
+    length = (length * 10) + static_cast<std::size_t>(c - '0');
+  }
+  //-----------------------------------
+  return length;
+}
+
+inline std::size_t Message::framed_length() const {
+  std::size_t length {Body::unknown_size};
+  //-----------------------------------
+  for (const auto field : header_fields_) {
+    if (header_fields::id(field.name) not_eq Header_id::Content_Length) continue;
+    //-----------------------------------
+    const auto value = parse_length(field.value);
+    if (value == Body::unknown_size) throw Message_error {"Invalid Content-Length"};
+    //-----------------------------------
+    // Differing lengths are how requests are smuggled past proxies
+    if (length not_eq Body::unknown_size and value not_eq length) {
+      throw Message_error {"Conflicting Content-Length fields"};
+    }
+    length = value;
+  }
+  //-----------------------------------
+  return length;
+}
+
+inline std::size_t Message::derived_length() const noexcept {
+  const auto size = message_body_.size();
+  //-----------------------------------
+  if (size == 0 or size == Body::unknown_size) return 0;
+  if (header_fields_.has_field(Header_id::Content_Length)) return 0;
+  if (header_fields_.has_field(Header_id::Transfer_Encoding)) return 0;
+  //-----------------------------------
+  return size;
+}
+
+inline void Message::drop_content_length() noexcept {
+  if (header_fields_.has_field(Header_id::Content_Length)) {
+    erase_header(header_fields::Entity::Content_Length);
+  }
+}
+
+inline bool Message::derives_chunked() const noexcept {
+  return message_body_.size() == Body::unknown_size
+         and not header_fields_.has_field(Header_id::Content_Length)
+         and not header_fields_.has_field(Header_id::Transfer_Encoding);
+}
+
+inline std::size_t Message::head_size() const noexcept {
+  if (derives_chunked()) {
+    return header_fields_.serialized_size() + header_fields::General::Transfer_Encoding.size() + 11;
+  }
+  //-----------------------------------
+  const auto length = derived_length();
+  //-----------------------------------
+  return header_fields_.serialized_size()
+         + ((length == 0) ? 0 : header_fields::Entity::Content_Length.size() + 2
+                                + format::decimal_size(length) + 2);
+}
+
+inline char* Message::serialize_head_into(char* out) const noexcept {
+  out = header_fields_.serialize_into(out);
+  //-----------------------------------
+  if (derives_chunked()) {
+    out = format::write(out - 2, header_fields::General::Transfer_Encoding);
+    return format::write(out, ": chunked\r\n\r\n");
+  }
+  //-----------------------------------
+  const auto length = derived_length();
+  if (length == 0) return out;
+  //-----------------------------------
+  // The derived field goes in front of the empty line that ends
+  // the header section
+  out = format::write(out - 2, header_fields::Entity::Content_Length);
+  out = format::write(out, ": ");
+  out = format::write_decimal(out, length);
+  return format::write(out, "\r\n\r\n");
+}
+
 inline Message& Message::clear_body() noexcept {
   message_body_.clear();
+  trailer_fields_.clear();
   return erase_header(header_fields::Entity::Content_Length);
 }
 
@@ -451,13 +1036,72 @@ inline Message& Message::reset() noexcept {
   return clear_headers().clear_body();
 }
 
+inline bool Message::sends_chunked() const noexcept {
+  return derives_chunked()
+         or (header_fields_.has_field(Header_id::Transfer_Encoding)
+             and is_chunked(header_fields_.get_value(Header_id::Transfer_Encoding)));
+}
+
+inline std::size_t Message::serialized_size() const {
+  const auto body_size = message_body_.size();
+  if (body_size == Body::unknown_size) return head_size();
+  //-----------------------------------
+  // A known entity is sent as a single chunk followed by the last chunk
+  if (sends_chunked()) {
+    return head_size() + ((body_size == 0) ? 0 : format::hex_size(body_size) + 2 + body_size + 2) + 5;
+  }
+  //-----------------------------------
+  return head_size() + body_size;
+}
+
+inline char* Message::serialize_into(char* out) const {
+  out = serialize_head_into(out);
+  //-----------------------------------
+  const auto body_size = message_body_.size();
+  if (body_size == Body::unknown_size or not sends_chunked()) return message_body_.copy_into(out);
+  //-----------------------------------
+  if (body_size > 0) {
+    out = format::write(format::write_hex(out, body_size), "\r\n");
+    out = format::write(message_body_.copy_into(out), "\r\n");
+  }
+  //-----------------------------------
+  return format::write(out, "0\r\n\r\n");
+}
+
+inline void Message::write_to(Writer& out) const {
+  std::pmr::string head {resource()};
+  head.resize(head_size());
+  serialize_head_into(head.data());
+  //-----------------------------------
+  out.write(head);
+  write_body_to(out);
+}
+
+inline void Message::write_body_to(Writer& out) const {
+  if (not sends_chunked()) return message_body_.write_to(out);
+  //-----------------------------------
+  Chunked_encoder encoder {out};
+  message_body_.write_to(encoder);
+  encoder.finish();
+}
+
+inline void Message::append_to(std::string& out) const {
+  if (message_body_.size() == Body::unknown_size) {
+    String_writer writer {out};
+    return write_to(writer);
+  }
+  //-----------------------------------
+  const auto size = out.size();
+  out.resize(size + serialized_size());
+  serialize_into(&out[size]);
+}
+
 inline std::string Message::to_string() const {
-  std::ostringstream message;
+  std::string message;
   //-----------------------------------
-  message << header_fields_
-          << message_body_;
+  append_to(message);
   //-----------------------------------
-  return message.str();
+  return message;
 }
 
 inline Message::operator std::string () const {
@@ -19,15 +19,18 @@
 #define HTTP_METHODS_HPP
 
 #include <array>
-#include <string>
+#include <cstdint>
 #include <ostream>
-#include <unordered_map>
+#include <string_view>
 
 namespace http {
 
   /**
    * @enum This type consist of mappings from HTTP method strings
    * to their respective internal code values
+   *
+   * Extension methods registered with {method::register_method}
+   * are assigned the codes following {PATCH}
    */
   enum Method {
     GET, POST, PUT, DELETE, OPTIONS, HEAD, TRACE, CONNECT, PATCH,
@@ -37,59 +40,156 @@ namespace http {
   namespace method {
 
     /**
-     * @brief Get the string representation from an HTTP
-     * method code
-     *
-     * @param m:
-     * The HTTP method code
-     *
-     * @return The string representation of the code
+     * @brief The standard method tokens indexed by their code
+     */
+    inline constexpr std::array<std::string_view, PATCH + 1> standard_methods {{
+      "GET", "POST", "PUT", "DELETE", "OPTIONS",
+      "HEAD", "TRACE", "CONNECT", "PATCH"
+    }};
+
+    /**
+     * @brief The most extension methods that can be registered
      */
-    static const std::string& str(const Method m) {
+    constexpr std::size_t max_extensions {16};
 
-      const static std::array<std::string, 10> strings
-      {
-        {
-         "GET", "POST", "PUT", "DELETE", "OPTIONS",
-         "HEAD", "TRACE", "CONNECT", "PATCH", "INVALID"
-        }
-      };
+    /**
+     * @brief The longest extension method token that can be registered
+     */
+    constexpr std::size_t max_extension_size {23};
 
-      auto e = strings.size() - 1;
+    /**
+     * @brief Check if a character is a token character (tchar)
+     * as defined in RFC 7230, section 3.2.6
+     */
+    constexpr bool is_tchar(const char c) noexcept {
+      return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or (c >= '0' and c <= '9')
+          or c == '!' or c == '#' or c == '$' or c == '%' or c == '&' or c == '\''
+          or c == '*' or c == '+' or c == '-' or c == '.' or c == '^' or c == '_'
+          or c == '`' or c == '|' or c == '~';
+    }
 
-      if ((m >= 0) and (m < e)) {
-        return strings[m];
+    /**
+     * @brief Pack a token of up to 7 bytes, along with its length,
+     * into a single integer so a token can be recognized with one
+     * integer compare
+     *
+     * @param token:
+     * The token to pack
+     *
+     * @return The packed token, or 0 if the token is too long
+     */
+    constexpr uint64_t pack(std::string_view token) noexcept {
+      if (token.size() > 7) return 0;
+      //-----------------------------------
+      uint64_t packed {static_cast<uint64_t>(token.size()) << 56};
+      for (std::size_t i = 0; i < token.size(); ++i) {
+        packed |= static_cast<uint64_t>(static_cast<unsigned char>(token[i])) << (i * 8);
       }
+      return packed;
+    }
 
-      return strings[e];
+    /**
+     * @brief The registered extension methods
+     *
+     * Registration is meant to happen once at startup, before
+     * any request is parsed; lookups are not synchronized with it
+     */
+    struct Extension_methods {
+      std::array<std::array<char, max_extension_size>, max_extensions> names;
+      std::array<uint8_t, max_extensions>                              sizes;
+      std::size_t                                                      count;
+
+      constexpr std::string_view name(const std::size_t i) const noexcept
+      { return {names[i].data(), sizes[i]}; }
+    };
+
+    inline Extension_methods& extension_methods() noexcept {
+      static Extension_methods methods {}; //< Constant-initialized
+      return methods;
     }
 
     /**
      * @brief Get a code mapping from an HTTP
      * method string
      *
+     * Standard methods are recognized with a single integer
+     * compare, extension methods with a compare per registered
+     * method
+     *
      * @param method:
-     * The HTTP method code
+     * The HTTP method string
      *
      * @return The code mapped to the method string
      **/
-    inline Method code(const std::string& method) noexcept {
-
-      const static std::unordered_map<std::string, Method> code_map {
-        {"GET",     GET},
-        {"POST",    POST},
-        {"PUT",     PUT},
-        {"DELETE",  DELETE},
-        {"OPTIONS", OPTIONS},
-        {"HEAD",    HEAD},
-        {"TRACE",   TRACE},
-        {"CONNECT", CONNECT},
-        {"PATCH",   PATCH}
-      };
-
-      auto it = code_map.find(method);
-
-      return (it not_eq code_map.end()) ? it->second : INVALID;
+    inline Method code(std::string_view method) noexcept {
+      switch (pack(method)) {
+        case pack("GET"):     return GET;
+        case pack("POST"):    return POST;
+        case pack("PUT"):     return PUT;
+        case pack("DELETE"):  return DELETE;
+        case pack("OPTIONS"): return OPTIONS;
+        case pack("HEAD"):    return HEAD;
+        case pack("TRACE"):   return TRACE;
+        case pack("CONNECT"): return CONNECT;
+        case pack("PATCH"):   return PATCH;
+        default: break;
+      }
+      //-----------------------------------
+      const auto& extensions = extension_methods();
+      for (std::size_t i = 0; i < extensions.count; ++i) {
+        if (extensions.name(i) == method) return static_cast<Method>(PATCH + 1 + i);
+      }
+      //-----------------------------------
+      return INVALID;
+    }
+
+    /**
+     * @brief Register an extension method, such as the WebDAV
+     * PROPFIND or a cache PURGE, so requests using it are accepted
+     *
+     * Must be called before requests are parsed
+     *
+     * @param method:
+     * The method token
+     *
+     * @return The code assigned to the method, the existing code if
+     * it is already known, or {INVALID} if the token is malformed,
+     * too long or the registry is full
+     */
+    inline Method register_method(std::string_view method) noexcept {
+      if (method.empty() or method.size() > max_extension_size) return INVALID;
+      for (const char c : method) if (not is_tchar(c)) return INVALID;
+      //-----------------------------------
+      const Method existing = code(method);
+      if (existing not_eq INVALID) return existing;
+      //-----------------------------------
+      auto& extensions = extension_methods();
+      if (extensions.count == max_extensions) return INVALID;
+      //-----------------------------------
+      const std::size_t i = extensions.count;
+      for (std::size_t j = 0; j < method.size(); ++j) extensions.names[i][j] = method[j];
+      extensions.sizes[i] = static_cast<uint8_t>(method.size());
+      extensions.count    = i + 1;
+      //-----------------------------------
+      return static_cast<Method>(PATCH + 1 + i);
+    }
+
+    /**
+     * @brief Get the string representation from an HTTP
+     * method code
+     *
+     * @param m:
+     * The HTTP method code
+     *
+     * @return The string representation of the code
+     */
+    inline std::string_view str(const Method m) noexcept {
+      if (m >= GET and m <= PATCH) return standard_methods[m];
+      //-----------------------------------
+      const auto& extensions = extension_methods();
+      const std::size_t i    = static_cast<std::size_t>(m) - (PATCH + 1);
+      //-----------------------------------
+      return (m > PATCH and i < extensions.count) ? extensions.name(i) : "INVALID";
     }
 
     inline bool is_content_length_allowed(const Method method) noexcept {
@@ -18,16 +18,28 @@
 #ifndef HTTP_MIME_TYPES_HPP
 #define HTTP_MIME_TYPES_HPP
 
+#include <array>
+#include <cstdio>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#include "ascii.hpp"
 
 namespace http {
 //------------------------------------------------
-using Extension       = std::string;
-using Mime_type       = std::string;
-using Mime_type_table = std::unordered_map<Extension, Mime_type>;
+using Extension = std::string_view;
+using Mime_type = std::string_view;
+//------------------------------------------------
+struct Mime_mapping {
+  Extension extension;
+  Mime_type type;
+};
 //------------------------------------------------
-const Mime_type_table mime_types {
+inline constexpr std::array<Mime_mapping, 57> mime_types {{
   //< Text mimes
   {"html", "text/html"},
   {"htm" , "text/html"},
@@ -94,16 +106,409 @@ const Mime_type_table mime_types {
   {"msi" , "application/octet-stream"},
   {"msp" , "application/octet-stream"},
   {"msm" , "application/octet-stream"}
-}; //< mime_types
+}}; //< mime_types
+
+/**
+ * @brief Case-insensitive seeded hash of a file extension
+ *
+ * FNV-1a over the lower case bytes followed by a final mix, so
+ * different seeds give independent slots
+ *
+ * @param extension:
+ * The extension to hash
+ *
+ * @param seed:
+ * The seed
+ *
+ * @return The hash of the extension
+ */
+constexpr uint32_t mime_hash(std::string_view extension, const uint32_t seed) noexcept {
+  uint32_t hash {2166136261u ^ seed};
+  //------------------------------------------------
+  for (const char c : extension) {
+    hash = (hash ^ static_cast<unsigned char>(to_lower(c))) * 16777619u;
+  }
+  //------------------------------------------------
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bu;
+  hash ^= hash >> 13;
+  return hash;
+}
+
+/**
+ * @brief Compile-time perfect hash table over {mime_types}
+ *
+ * The seed was chosen so that no two extensions share a slot,
+ * which is checked at compile-time below
+ */
+struct Mime_slots {
+  static constexpr std::size_t size {256};
+  static constexpr uint32_t    seed {1229};
+  //------------------------------------------------
+  std::array<uint8_t, size> slots; //< 1-based index into {mime_types}, 0 if empty
+  bool perfect {true};
+};
+
+constexpr Mime_slots make_mime_slots() noexcept {
+  Mime_slots table {};
+  //------------------------------------------------
+  for (std::size_t i = 0; i < mime_types.size(); ++i) {
+    auto& slot = table.slots[mime_hash(mime_types[i].extension, Mime_slots::seed) & (Mime_slots::size - 1)];
+    if (slot not_eq 0) table.perfect = false;
+    slot = static_cast<uint8_t>(i + 1);
+  }
+  //------------------------------------------------
+  return table;
+}
+
+inline constexpr Mime_slots mime_slots {make_mime_slots()};
+
+static_assert(mime_slots.perfect, "Extensions in mime_types collide in the perfect hash table");
+
+/**
+ * @brief The MIME type of unknown extensions
+ */
+inline constexpr Mime_type default_mime_type {"application/octet-stream"};
+
+/**
+ * @brief Get the MIME type of a file extension from the
+ * built-in table
+ *
+ * @param extension:
+ * The file extension without the leading '.' (case-insensitive)
+ *
+ * @return The MIME type of the extension, or an empty view
+ * if it is unknown
+ */
+constexpr Mime_type builtin_extension_to_type(const Extension extension) noexcept {
+  const auto slot = mime_slots.slots[mime_hash(extension, Mime_slots::seed) & (Mime_slots::size - 1)];
+  if (slot == 0) return {};
+  //------------------------------------------------
+  const auto& mapping = mime_types[slot - 1];
+  return iequals(mapping.extension, extension) ? mapping.type : Mime_type{};
+}
+
+/**
+ * @brief Get the extension of the last segment of a path
+ *
+ * Any query or fragment is ignored, as are leading dots of
+ * hidden files
+ *
+ * @param path:
+ * The path, e.g. "/static/app.min.js?v=2"
+ *
+ * @return The extension without the leading '.', e.g. "js",
+ * or an empty view if there is none
+ */
+constexpr Extension path_extension(const std::string_view path) noexcept {
+  std::size_t segment {0};
+  std::size_t dot     {std::string_view::npos};
+  std::size_t end     {0};
+  //------------------------------------------------
+  for (; end < path.size(); ++end) {
+    const char c = path[end];
+    if (c == '?' or c == '#') break;
+    if (c == '/') {
+      segment = end + 1;
+      dot     = std::string_view::npos;
+    }
+    else if (c == '.') dot = end;
+  }
+  //------------------------------------------------
+  if (dot == std::string_view::npos or dot == segment) return {};
+  //------------------------------------------------
+  return path.substr(dot + 1, end - dot - 1);
+}
+
+/**
+ * @brief This class represents a frozen, read-only mapping
+ * from file extensions to MIME types that is built once,
+ * typically from a file in the /etc/mime.types format:
+ *
+ * "# comment"
+ * "type/subtype  ext1 ext2 ..."
+ *
+ * Lookups are case-insensitive and go through a hash-and-displace
+ * perfect hash, so each costs two hashes and one compare, and
+ * never allocates
+ */
+class Mime_table {
+public:
+  /**
+   * @brief Default constructor which creates an empty table
+   */
+  explicit Mime_table() = default;
+
+  /**
+   * @brief Construct a table from text in the /etc/mime.types
+   * format
+   *
+   * Extensions listed more than once keep their first type
+   *
+   * @param text:
+   * The table text
+   */
+  explicit Mime_table(std::string_view text);
+
+  /**
+   * @brief Construct a table from a file in the /etc/mime.types
+   * format
+   *
+   * @param path:
+   * The path of the file
+   *
+   * @return The table
+   *
+   * @note Throws {Mime_table_error} if the file cannot be read
+   */
+  static Mime_table from_file(const char* path);
+
+  /**
+   * @brief Get the MIME type of a file extension
+   *
+   * @param extension:
+   * The file extension without the leading '.' (case-insensitive)
+   *
+   * @return The MIME type of the extension, or an empty view
+   * if it is not in the table
+   */
+  Mime_type find(const Extension extension) const noexcept;
+
+  /**
+   * @brief Get the number of extensions in the table
+   *
+   * @return The number of extensions
+   */
+  std::size_t size() const noexcept
+  { return size_; }
+private:
+  //------------------------------------------------
+  // A slot refers to an extension and its type in {bytes_}
+  struct Slot {
+    uint32_t extension_offset;
+    uint32_t type_offset;
+    uint16_t type_size;
+    uint8_t  extension_size; //< 0 if the slot is empty
+  };
+  //------------------------------------------------
+  // Class data members
+  std::string           bytes_;
+  std::vector<Slot>     slots_;
+  std::vector<uint32_t> seeds_; //< Displacement seed per bucket
+  std::size_t           size_ {0};
+  //------------------------------------------------
+
+  /**
+   * @brief Get the extension a slot refers to
+   */
+  std::string_view extension(const Slot& slot) const noexcept
+  { return {bytes_.data() + slot.extension_offset, slot.extension_size}; }
 
-inline const Mime_type& extension_to_type(const Extension& extension) noexcept {
-  auto it = mime_types.find(extension);
+  /**
+   * @brief Build the perfect hash over the parsed entries
+   */
+  void freeze(std::vector<Slot> entries);
+}; //< class Mime_table
+
+/**
+ * @brief This class is used to represent an error that occurred
+ * from within the operations of class Mime_table
+ */
+class Mime_table_error : public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
+/**--v----------- Implementation Details -----------v--**/
+
+inline Mime_table::Mime_table(std::string_view text) {
+  auto is_space = [](const char c) {
+    return c == ' ' or c == '\t' or c == '\r' or c == '\v' or c == '\f';
+  };
+  //------------------------------------------------
+  std::vector<Slot> entries;
+  bytes_.reserve(text.size());
+  //------------------------------------------------
+  while (not text.empty()) {
+    const auto eol = text.find('\n');
+    auto line = text.substr(0, eol);
+    text.remove_prefix((eol == std::string_view::npos) ? text.size() : eol + 1);
+    //------------------------------------------------
+    line = line.substr(0, line.find('#'));
+    //------------------------------------------------
+    // Split the line into whitespace separated tokens
+    auto next_token = [&line, &is_space]() {
+      while (not line.empty() and is_space(line.front())) line.remove_prefix(1);
+      std::size_t n {0};
+      while (n < line.size() and not is_space(line[n])) ++n;
+      const auto token = line.substr(0, n);
+      line.remove_prefix(n);
+      return token;
+    };
+    //------------------------------------------------
+    const auto type = next_token();
+    if (type.find('/') == std::string_view::npos or type.size() > UINT16_MAX) continue;
+    //------------------------------------------------
+    const auto type_offset = static_cast<uint32_t>(bytes_.size());
+    bytes_.append(type.data(), type.size());
+    //------------------------------------------------
+    for (auto ext = next_token(); not ext.empty(); ext = next_token()) {
+      if (ext.size() > UINT8_MAX) continue;
+      //------------------------------------------------
+      const auto extension_offset = static_cast<uint32_t>(bytes_.size());
+      for (const char c : ext) bytes_ += to_lower(c);
+      //------------------------------------------------
+      entries.push_back({extension_offset, type_offset,
+                         static_cast<uint16_t>(type.size()), static_cast<uint8_t>(ext.size())});
+    }
+  }
+  //------------------------------------------------
+  freeze(std::move(entries));
+}
+
+inline Mime_table Mime_table::from_file(const char* path) {
+  std::FILE* file = std::fopen(path, "rb");
+  if (file == nullptr) throw Mime_table_error {std::string{"Cannot open "} + path};
+  //------------------------------------------------
+  std::string text;
+  char buffer[4096];
+  for (std::size_t n; (n = std::fread(buffer, 1, sizeof buffer, file)) > 0;) text.append(buffer, n);
+  //------------------------------------------------
+  const bool failed = std::ferror(file);
+  std::fclose(file);
+  if (failed) throw Mime_table_error {std::string{"Cannot read "} + path};
+  //------------------------------------------------
+  return Mime_table{text};
+}
+
+inline void Mime_table::freeze(std::vector<Slot> entries) {
+  // Keep the first type of an extension listed more than once
+  std::stable_sort(entries.begin(), entries.end(), [this](const Slot& lhs, const Slot& rhs) {
+    return extension(lhs) < extension(rhs);
+  });
+  entries.erase(std::unique(entries.begin(), entries.end(), [this](const Slot& lhs, const Slot& rhs) {
+    return extension(lhs) == extension(rhs);
+  }), entries.end());
+  //------------------------------------------------
+  size_ = entries.size();
+  if (size_ == 0) return;
+  //------------------------------------------------
+  // Hash and displace: group the extensions into buckets of about
+  // four, then place the largest buckets first, searching for a
+  // seed per bucket that sends all of its extensions to free slots
+  const std::size_t bucket_count = (size_ + 3) / 4;
+  std::vector<std::vector<uint32_t>> buckets(bucket_count);
+  for (uint32_t i = 0; i < size_; ++i) {
+    buckets[mime_hash(extension(entries[i]), 0) % bucket_count].push_back(i);
+  }
+  //------------------------------------------------
+  std::vector<uint32_t> order(bucket_count);
+  for (uint32_t b = 0; b < bucket_count; ++b) order[b] = b;
+  std::stable_sort(order.begin(), order.end(), [&buckets](const uint32_t lhs, const uint32_t rhs) {
+    return buckets[lhs].size() > buckets[rhs].size();
+  });
   //------------------------------------------------
-  return (it not_eq mime_types.end())
-          ? it->second
-          : const_cast<Mime_type_table&>(mime_types)["bin"];
+  std::size_t slot_count {1};
+  while (slot_count < size_) slot_count <<= 1;
+  //------------------------------------------------
+  std::vector<std::size_t> taken;
+  for (bool placed = false; not placed; slot_count <<= 1) {
+    slots_.assign(slot_count, Slot{0, 0, 0, 0});
+    seeds_.assign(bucket_count, 0);
+    placed = true;
+    //------------------------------------------------
+    for (const auto b : order) {
+      if (buckets[b].empty()) break;
+      //------------------------------------------------
+      uint32_t seed {1};
+      for (; seed < (1u << 16); ++seed) {
+        taken.clear();
+        for (const auto i : buckets[b]) {
+          const std::size_t slot = mime_hash(extension(entries[i]), seed) & (slot_count - 1);
+          if (slots_[slot].extension_size not_eq 0
+              or std::find(taken.begin(), taken.end(), slot) not_eq taken.end()) break;
+          taken.push_back(slot);
+        }
+        if (taken.size() == buckets[b].size()) break;
+      }
+      //------------------------------------------------
+      // Out of seeds: start over with twice the slots
+      if (taken.size() not_eq buckets[b].size()) {
+        placed = false;
+        break;
+      }
+      //------------------------------------------------
+      seeds_[b] = seed;
+      for (std::size_t k = 0; k < taken.size(); ++k) slots_[taken[k]] = entries[buckets[b][k]];
+    }
+    //------------------------------------------------
+    if (placed) break;
+  }
+}
+
+inline Mime_type Mime_table::find(const Extension extension) const noexcept {
+  if (size_ == 0 or extension.empty()) return {};
+  //------------------------------------------------
+  const auto  seed = seeds_[mime_hash(extension, 0) % seeds_.size()];
+  const auto& slot = slots_[mime_hash(extension, seed) & (slots_.size() - 1)];
+  //------------------------------------------------
+  if (slot.extension_size == 0 or not iequals(this->extension(slot), extension)) return {};
+  //------------------------------------------------
+  return {bytes_.data() + slot.type_offset, slot.type_size};
+}
+
+/**
+ * @brief Get the table installed with {load_mime_types}
+ */
+inline Mime_table& loaded_mime_types() noexcept {
+  static Mime_table table;
+  return table;
 }
 
+/**
+ * @brief Install a table that takes precedence over the built-in
+ * table in {extension_to_type} and {path_to_type}
+ *
+ * Must be called once at startup, before lookups are made from
+ * other threads
+ *
+ * @param table:
+ * The table, e.g. Mime_table::from_file("/etc/mime.types")
+ */
+inline void load_mime_types(Mime_table table) {
+  loaded_mime_types() = std::move(table);
+}
+
+/**
+ * @brief Get the MIME type of a file extension
+ *
+ * @param extension:
+ * The file extension without the leading '.' (case-insensitive)
+ *
+ * @return The MIME type of the extension, or
+ * "application/octet-stream" if it is unknown
+ */
+inline Mime_type extension_to_type(const Extension extension) noexcept {
+  auto type = loaded_mime_types().find(extension);
+  if (type.empty()) type = builtin_extension_to_type(extension);
+  //------------------------------------------------
+  return type.empty() ? default_mime_type : type;
+}
+
+/**
+ * @brief Get the MIME type of the resource at a path
+ *
+ * @param path:
+ * The path, e.g. the path of a request URI
+ *
+ * @return The MIME type of the extension of the path, or
+ * "application/octet-stream" if it is unknown
+ */
+inline Mime_type path_to_type(std::string_view path) noexcept {
+  return extension_to_type(path_extension(path));
+}
+
+/**--^----------- Implementation Details -----------^--**/
+
 } //< namespace http
 
 #endif //< HTTP_MIME_TYPES_HPP
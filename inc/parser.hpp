@@ -0,0 +1,616 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_PARSER_HPP
+#define HTTP_PARSER_HPP
+
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <string_view>
+
+#include "chunked.hpp"
+#include "request_view.hpp"
+#include "response.hpp"
+
+namespace http {
+
+/**
+ * @brief This class is a push-style, resumable parser for HTTP/1.x
+ * messages arriving in arbitrary segments
+ *
+ * Bytes are handed to the parser with {feed} as they arrive. The
+ * head (start-line and header section) is collected across calls and
+ * each byte of it is examined exactly once. Body bytes are never
+ * copied; they are handed to the body handler as views into the
+ * segment that was fed. A chunked body is decoded on the way, so
+ * the handler only sees chunk data
+ *
+ * Typical use on a connection:
+ *
+ *   while (len > 0) {
+ *     auto status = parser.feed(data, len);
+ *     data += parser.consumed();
+ *     len  -= parser.consumed();
+ *     ...
+ *   }
+ */
+class Parser {
+public:
+  /**
+   * @brief The kind of message to parse
+   */
+  enum class Mode {
+    Request,
+    Response
+  };
+
+  /**
+   * @brief Progress of the message being parsed
+   *
+   * {feed} reports {Headers_complete} once, from the call that
+   * completes the head, and {Message_complete} from the call that
+   * completes the message. {Message_complete} implies that the
+   * head is complete
+   */
+  enum class Status {
+    Need_more,
+    Headers_complete,
+    Message_complete
+  };
+
+  /**
+   * @brief Receives body bytes as they arrive
+   */
+  using Body_handler = std::function<void(std::string_view)>;
+
+  /**
+   * @brief Constructor
+   *
+   * @param mode:
+   * The kind of message to parse
+   *
+   * @param head_limit:
+   * Maximum number of bytes in the start-line and header section
+   */
+  explicit Parser(const Mode mode, const Limit head_limit = 8192);
+
+  /**
+   * @brief Set the handler that receives body bytes
+   *
+   * Without a handler body bytes are consumed and discarded
+   *
+   * @param handler:
+   * The body handler
+   *
+   * @return The object that invoked this method
+   */
+  Parser& on_body(Body_handler handler);
+
+  /**
+   * @brief Set the maximum number of bytes in a body
+   *
+   * A body declared longer by its {Content-Length} field, or a
+   * chunked or close-delimited body growing longer, is rejected
+   *
+   * @param max_body_size:
+   * The maximum number of bytes
+   *
+   * @return The object that invoked this method
+   */
+  Parser& set_max_body_size(const std::size_t max_body_size) noexcept;
+
+  /**
+   * @brief Set the method of the request the next response answers
+   *
+   * A response to HEAD has no body whatever its framing fields
+   * say, just as a 1xx, 204 or 304 response (RFC 7230 §3.3.3).
+   * {reset} restores GET, so the method is set again for each
+   * response, before its head is fed
+   *
+   * @param method:
+   * The method of the request
+   *
+   * @return The object that invoked this method
+   */
+  Parser& set_request_method(const Method method) noexcept;
+
+  /**
+   * @brief Parse the next segment of the message
+   *
+   * Parsing stops at the end of the head and at the end of the
+   * message, so bytes of a following message are never consumed
+   *
+   * @param data:
+   * The segment to parse
+   *
+   * @param len:
+   * The number of bytes in the segment
+   *
+   * @return The progress of the message
+   *
+   * @note Throws {Parser_error} if the head is malformed or too large,
+   * or if the body is malformed or too large
+   */
+  Status feed(const char* data, const std::size_t len);
+
+  /**
+   * @brief Signal that the peer closed the connection
+   *
+   * Completes a response whose body is delimited by the end
+   * of the connection. A close before any byte of a message, the
+   * normal end of a keep-alive connection, leaves nothing to
+   * complete and reports {Need_more}
+   *
+   * @return The progress of the message
+   *
+   * @note Throws {Parser_error} if a message is partly parsed
+   */
+  Status finish();
+
+  /**
+   * @brief Get the number of bytes consumed by the last call
+   * to {feed}
+   *
+   * @return The number of bytes consumed
+   */
+  std::size_t consumed() const noexcept
+  { return consumed_; }
+
+  /**
+   * @brief Get the progress of the current message
+   *
+   * @return The progress of the current message
+   */
+  Status status() const noexcept;
+
+  /**
+   * @brief Get the raw head of the message, including the
+   * blank line that ends it
+   *
+   * Only complete once {feed} has reported the head complete
+   *
+   * @return The head of the message
+   */
+  std::string_view head() const noexcept
+  { return head_; }
+
+  /**
+   * @brief Get the method of a parsed request
+   *
+   * @return The method of the request
+   */
+  Method method() const noexcept
+  { return method_; }
+
+  /**
+   * @brief Get the status code of a parsed response
+   *
+   * @return The status code of the response
+   */
+  Code status_code() const noexcept
+  { return code_; }
+
+  /**
+   * @brief Check if the body is in the chunked transfer coding
+   *
+   * @return true if the body is chunked, false otherwise
+   */
+  bool is_chunked() const noexcept
+  { return chunked_; }
+
+  /**
+   * @brief Get the trailer fields of a chunked body, complete
+   * once the message is
+   *
+   * @return The trailer fields
+   */
+  const Header& trailers() const noexcept
+  { return decoder_.trailers(); }
+
+  /**
+   * @brief Check if the length of the body is known
+   *
+   * @return false if the body is chunked or delimited by the
+   * end of the connection, true otherwise
+   */
+  bool has_content_length() const noexcept
+  { return body_length_ not_eq unknown_length; }
+
+  /**
+   * @brief Get the length of the body
+   *
+   * @return The length of the body if known, 0 otherwise
+   */
+  std::size_t content_length() const noexcept
+  { return has_content_length() ? body_length_ : 0; }
+
+  /**
+   * @brief Get a view of the parsed request head
+   *
+   * The view points into the parser, so it is invalidated
+   * by {reset}
+   *
+   * @return A view of the request head
+   */
+  Request_view request_view() const;
+
+  /**
+   * @brief Copy the parsed head into an owning {Request}
+   *
+   * @return The request without its body
+   */
+  Request request() const;
+
+  /**
+   * @brief Copy the parsed head into an owning {Response}
+   *
+   * @return The response without its body
+   */
+  Response response() const;
+
+  /**
+   * @brief Prepare the parser for the next message on the
+   * same connection
+   *
+   * Previously allocated capacity is retained
+   */
+  void reset() noexcept;
+private:
+  //----------------------------------------
+  // Internal state of the parser
+  enum class State {
+    Start_line,
+    Fields,
+    Body,
+    Done
+  };
+
+  static constexpr std::size_t unknown_length {static_cast<std::size_t>(-1)};
+  //----------------------------------------
+  // Class data members
+  Mode            mode_;
+  State           state_ {State::Start_line};
+  Limit           head_limit_;
+  std::string     head_;
+  std::size_t     line_start_ {0};
+  std::size_t     consumed_ {0};
+  std::size_t     body_length_ {0};
+  std::size_t     body_received_ {0};
+  std::size_t     max_body_size_ {Chunked_decoder::unlimited};
+  bool            has_length_field_ {false};
+  bool            chunked_ {false};
+  bool            encoded_ {false};
+  bool            seen_field_ {false}; //< A field line was completed, so a folded line may follow
+  Chunked_decoder decoder_;
+  Method          method_ {INVALID};
+  Method          request_method_ {GET}; //< The method a response answers
+  Code            code_ {0};
+  Body_handler    body_handler_;
+  //----------------------------------------
+
+  /**
+   * @brief Collect head bytes, one line at a time
+   */
+  Status parse_head(const char* data, const std::size_t len);
+
+  /**
+   * @brief Inspect a completed line of the head
+   *
+   * @return true if the line ends the head, false otherwise
+   */
+  bool complete_line(std::string_view line);
+
+  /**
+   * @brief Deliver body bytes to the body handler
+   */
+  Status parse_body(const char* data, const std::size_t len);
+
+  /**
+   * @brief Determine how the body is delimited once the
+   * head is complete
+   */
+  void frame_body();
+}; //< class Parser
+
+/**
+ * @brief This class is used to represent an error that occurred
+ * from within the operations of class Parser
+ */
+class Parser_error : public std::runtime_error {
+  using runtime_error::runtime_error;
+};
+
+/**--v----------- Implementation Details -----------v--**/
+
+inline Parser::Parser(const Mode mode, const Limit head_limit)
+  : mode_{mode}
+  , head_limit_{head_limit}
+{}
+
+inline Parser& Parser::on_body(Body_handler handler) {
+  body_handler_ = std::move(handler);
+  return *this;
+}
+
+inline Parser& Parser::set_max_body_size(const std::size_t max_body_size) noexcept {
+  max_body_size_ = max_body_size;
+  decoder_.set_max_body_size(max_body_size);
+  return *this;
+}
+
+inline Parser& Parser::set_request_method(const Method method) noexcept {
+  request_method_ = method;
+  return *this;
+}
+
+inline Parser::Status Parser::feed(const char* data, const std::size_t len) {
+  consumed_ = 0;
+  //-----------------------------------
+  switch (state_) {
+    case State::Start_line:
+    case State::Fields: return parse_head(data, len);
+    case State::Body:   return parse_body(data, len);
+    default:            return Status::Message_complete;
+  }
+}
+
+inline Parser::Status Parser::finish() {
+  // Only empty lines, if anything, arrived since the last message
+  if (state_ == State::Start_line and head_.empty()) return Status::Need_more;
+  //-----------------------------------
+  if (state_ == State::Body and body_length_ == unknown_length and not chunked_) {
+    state_ = State::Done;
+  }
+  //-----------------------------------
+  if (state_ not_eq State::Done) {
+    throw Parser_error {"Connection closed before the message was complete"};
+  }
+  //-----------------------------------
+  return Status::Message_complete;
+}
+
+inline Parser::Status Parser::status() const noexcept {
+  switch (state_) {
+    case State::Start_line:
+    case State::Fields: return Status::Need_more;
+    case State::Body:   return Status::Headers_complete;
+    default:            return Status::Message_complete;
+  }
+}
+
+inline Parser::Status Parser::parse_head(const char* data, const std::size_t len) {
+  const char* cursor = data;
+  const char* const end = data + len;
+  //-----------------------------------
+  while (cursor < end) {
+    // Tolerate empty lines preceding the start-line (RFC 7230 §3.5)
+    if (state_ == State::Start_line and head_.empty() and (*cursor == '\r' or *cursor == '\n')) {
+      ++cursor;
+      continue;
+    }
+    //-----------------------------------
+    auto eol = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+    auto segment_end = (eol == nullptr) ? end : eol + 1;
+    //-----------------------------------
+    if (head_.size() + (segment_end - cursor) > head_limit_) {
+      throw Parser_error {"Message head exceeds " + std::to_string(head_limit_) + " bytes"};
+    }
+    //-----------------------------------
+    head_.append(cursor, segment_end);
+    cursor = segment_end;
+    //-----------------------------------
+    if (eol == nullptr) break;
+    //-----------------------------------
+    std::string_view line {head_.data() + line_start_, head_.size() - line_start_ - 1};
+    if (not line.empty() and line.back() == '\r') line.remove_suffix(1);
+    line_start_ = head_.size();
+    //-----------------------------------
+    if (complete_line(line)) {
+      consumed_ = cursor - data;
+      frame_body();
+      return (state_ == State::Done) ? Status::Message_complete : Status::Headers_complete;
+    }
+  }
+  //-----------------------------------
+  consumed_ = len;
+  return Status::Need_more;
+}
+
+inline bool Parser::complete_line(std::string_view line) {
+  if (state_ == State::Start_line) {
+    auto begin = head_.data();
+    auto end   = begin + head_.size();
+    //-----------------------------------
+    try {
+      if (mode_ == Mode::Request) {
+        Request_line_parts parts;
+        parse_request_line(begin, end, parts);
+        method_ = parts.method;
+      } else {
+        Status_line_parts parts;
+        parse_status_line(begin, end, parts);
+        code_ = parts.code;
+      }
+    } catch (const std::runtime_error& error) {
+      throw Parser_error {error.what()};
+    }
+    //-----------------------------------
+    state_ = State::Fields;
+    return false;
+  }
+  //-----------------------------------
+  if (line.empty()) return true;
+  //-----------------------------------
+  // A line-ending is CRLF or a bare LF, as for {Header}
+  if (line.find('\r') not_eq std::string_view::npos) throw Parser_error {"Bare CR in header section"};
+  //-----------------------------------
+  // obs-fold: the continuation belongs to the previous field
+  if (line.front() == ' ' or line.front() == '\t') {
+    if (not seen_field_) throw Parser_error {"Invalid header field: " + std::string{line}};
+    return false;
+  }
+  //-----------------------------------
+  auto colon = line.find(':');
+  if (colon == std::string_view::npos) throw Parser_error {"Invalid header field: " + std::string{line}};
+  //-----------------------------------
+  const auto name = line.substr(0, colon);
+  if (not is_field_name(name)) throw Parser_error {"Invalid header field name: " + std::string{name}};
+  //-----------------------------------
+  seen_field_ = true;
+  const Header_id id = header_fields::id(name);
+  //-----------------------------------
+  if (id not_eq Header_id::Content_Length and id not_eq Header_id::Transfer_Encoding) return false;
+  //-----------------------------------
+  auto value = line.substr(colon + 1);
+  auto first = value.find_first_not_of(" \t");
+  auto last  = value.find_last_not_of(" \t");
+  value = (first == std::string_view::npos) ? std::string_view{} : value.substr(first, last - first + 1);
+  //-----------------------------------
+  // Only a body whose final coding is chunked can be delimited,
+  // except by the end of the connection for a response (RFC 7230 §3.3.3)
+  if (id == Header_id::Transfer_Encoding) {
+    chunked_ = http::is_chunked(value);
+    encoded_ = true;
+    if (not chunked_ and mode_ == Mode::Request) throw Parser_error {"Unsupported Transfer-Encoding"};
+    return false;
+  }
+  //-----------------------------------
+  if (value.empty() or value.size() > 18) throw Parser_error {"Invalid Content-Length"};
+  //-----------------------------------
+  std::size_t length {0};
+  for (const char c : value) {
+    if (c < '0' or c > '9') throw Parser_error {"Invalid Content-Length"};
+    length = (length * 10) + static_cast<std::size_t>(c - '0');
+  }
+  //-----------------------------------
+  if (has_length_field_ and length not_eq body_length_) {
+    throw Parser_error {"Conflicting Content-Length fields"};
+  }
+  //-----------------------------------
+  has_length_field_ = true;
+  body_length_      = length;
+  return false;
+}
+
+inline void Parser::frame_body() {
+  if (mode_ == Mode::Response
+      and (request_method_ == HEAD or (code_ >= 100 and code_ < 200)
+           or code_ == No_Content or code_ == Not_Modified))
+  {
+    body_length_ = 0;
+  }
+  else if (chunked_) {
+    // A message with both is how requests are smuggled past proxies
+    if (has_length_field_) throw Parser_error {"Both Transfer-Encoding and Content-Length"};
+    body_length_ = unknown_length;
+  }
+  else if (encoded_) {
+    // The transfer coding overrides any Content-Length
+    body_length_ = unknown_length;
+  }
+  else if (not has_length_field_) {
+    body_length_ = (mode_ == Mode::Request) ? 0 : unknown_length;
+  }
+  else if (body_length_ > max_body_size_) {
+    throw Parser_error {"Body exceeds " + std::to_string(max_body_size_) + " bytes"};
+  }
+  //-----------------------------------
+  state_ = (body_length_ == 0) ? State::Done : State::Body;
+}
+
+inline Parser::Status Parser::parse_body(const char* data, const std::size_t len) {
+  if (chunked_) {
+    Chunked_decoder::Status status;
+    try {
+      status = decoder_.feed(data, len, [this](std::string_view bytes) {
+        if (body_handler_) body_handler_(bytes);
+      });
+    } catch (const std::runtime_error& error) {
+      throw Parser_error {error.what()};
+    }
+    //-----------------------------------
+    body_received_ = decoder_.body_size();
+    consumed_      = decoder_.consumed();
+    //-----------------------------------
+    if (status == Chunked_decoder::Status::Need_more) return Status::Need_more;
+    //-----------------------------------
+    state_ = State::Done;
+    return Status::Message_complete;
+  }
+  //-----------------------------------
+  std::size_t count = len;
+  //-----------------------------------
+  if (body_length_ not_eq unknown_length) {
+    count = std::min(len, body_length_ - body_received_);
+  }
+  else if (count > max_body_size_ - body_received_) {
+    throw Parser_error {"Body exceeds " + std::to_string(max_body_size_) + " bytes"};
+  }
+  //-----------------------------------
+  if (count > 0 and body_handler_) body_handler_({data, count});
+  //-----------------------------------
+  body_received_ += count;
+  consumed_       = count;
+  //-----------------------------------
+  if (body_received_ == body_length_) {
+    state_ = State::Done;
+    return Status::Message_complete;
+  }
+  //-----------------------------------
+  return Status::Need_more;
+}
+
+inline Request_view Parser::request_view() const {
+  return Request_view{head_.data(), head_.size()};
+}
+
+inline Request Parser::request() const {
+  return Request_view{head_.data(), head_.size()}.to_request();
+}
+
+inline Response Parser::response() const {
+  // Parsed as the answer to HEAD, so the framing fields are kept
+  // without looking for the body they announce
+  Response response;
+  response.parse(head_, HEAD);
+  return response;
+}
+
+inline void Parser::reset() noexcept {
+  state_            = State::Start_line;
+  line_start_       = 0;
+  consumed_         = 0;
+  body_length_      = 0;
+  body_received_    = 0;
+  has_length_field_ = false;
+  chunked_          = false;
+  encoded_          = false;
+  seen_field_       = false;
+  method_           = INVALID;
+  request_method_   = GET;
+  code_             = 0;
+  head_.clear();
+  decoder_.reset();
+}
+
+/**--^----------- Implementation Details -----------^--**/
+
+} //< namespace http
+
+#endif //< HTTP_PARSER_HPP
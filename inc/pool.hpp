@@ -0,0 +1,260 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_POOL_HPP
+#define HTTP_POOL_HPP
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <string_view>
+
+#include "request.hpp"
+#include "response.hpp"
+
+namespace http {
+
+/**
+ * @brief Counters describing the use of a pool
+ */
+struct Pool_stats {
+  std::size_t acquired   {0}; //< Objects handed out
+  std::size_t hits       {0}; //< Objects handed out from the idle list
+  std::size_t released   {0}; //< Objects given back
+  std::size_t in_use     {0}; //< Objects currently handed out
+  std::size_t high_water {0}; //< Highest value of {in_use}
+
+  /**
+   * @brief Get the fraction of objects handed out from the
+   * idle list
+   *
+   * @return The hit rate in [0, 1]
+   */
+  double hit_rate() const noexcept
+  { return (acquired == 0) ? 0.0 : static_cast<double>(hits) / acquired; }
+};
+
+/**
+ * @brief This class recycles messages so their storage (the
+ * header fields, the body and any rendered output) survives from
+ * one use to the next, which lets a keep-alive connection serve
+ * requests without touching the heap once it has warmed up
+ *
+ * Each thread has its own pool, see {local}, so no locking takes
+ * place. An object goes back to the pool that handed it out, so a
+ * handle is destroyed on the thread using that pool, and before the
+ * pool is destroyed. For the pool of a thread the latter matters for
+ * handles held by other thread-local objects: one destroyed after the
+ * pool at thread exit gives its object back to a destroyed pool
+ *
+ * @tparam T:
+ * The message type, which must provide {reset()}
+ */
+template <typename T>
+class Pool {
+public:
+  /**
+   * @brief Deleter that gives an object back to the pool that
+   * handed it out
+   */
+  struct Recycler {
+    Pool* pool {nullptr};
+
+    void operator()(T* object) const noexcept
+    { pool->release(object); }
+  };
+
+  /**
+   * @brief An object handed out by a pool
+   */
+  using Handle = std::unique_ptr<T, Recycler>;
+
+  /**
+   * @brief Constructor to specify how many idle objects are kept
+   *
+   * @param max_idle:
+   * Objects given back while this many are idle are destroyed
+   */
+  explicit Pool(const std::size_t max_idle = 64);
+
+  /**
+   * @brief Destroys the idle objects
+   */
+  ~Pool() noexcept;
+
+  Pool(const Pool&) = delete;
+  Pool& operator = (const Pool&) = delete;
+
+  /**
+   * @brief Get the pool of the calling thread
+   *
+   * @return The pool of the calling thread
+   */
+  static Pool& local() noexcept;
+
+  /**
+   * @brief Get an object, recycled if one is idle
+   *
+   * @return An object in its default constructed state
+   */
+  Handle acquire();
+
+  /**
+   * @brief Give an object back, resetting it
+   *
+   * @param object:
+   * The object, which must have been allocated with {new}
+   */
+  void release(T* object) noexcept;
+
+  /**
+   * @brief Get the counters of this pool
+   *
+   * @return The counters of this pool
+   */
+  const Pool_stats& stats() const noexcept
+  { return stats_; }
+
+  /**
+   * @brief Get the number of idle objects
+   *
+   * @return The number of idle objects
+   */
+  std::size_t idle() const noexcept
+  { return idle_.size(); }
+private:
+  //----------------------------------------
+  // Class data members
+  std::vector<T*> idle_;
+  std::size_t     max_idle_;
+  Pool_stats      stats_;
+  //----------------------------------------
+}; //< class Pool
+
+/**--v----------- Implementation Details -----------v--**/
+
+template <typename T>
+inline Pool<T>::Pool(const std::size_t max_idle)
+  : max_idle_{max_idle}
+{
+  idle_.reserve(max_idle_);
+}
+
+template <typename T>
+inline Pool<T>::~Pool() noexcept {
+  for (auto object : idle_) delete object;
+}
+
+template <typename T>
+inline Pool<T>& Pool<T>::local() noexcept {
+  thread_local Pool pool;
+  return pool;
+}
+
+template <typename T>
+inline typename Pool<T>::Handle Pool<T>::acquire() {
+  T* object {nullptr};
+  //-----------------------------------
+  if (idle_.empty()) object = new T;
+  else {
+    object = idle_.back();
+    idle_.pop_back();
+    ++stats_.hits;
+  }
+  //-----------------------------------
+  ++stats_.acquired;
+  if (++stats_.in_use > stats_.high_water) stats_.high_water = stats_.in_use;
+  //-----------------------------------
+  return Handle{object, Recycler{this}};
+}
+
+template <typename T>
+inline void Pool<T>::release(T* object) noexcept {
+  if (object == nullptr) return;
+  //-----------------------------------
+  ++stats_.released;
+  if (stats_.in_use > 0) --stats_.in_use;
+  //-----------------------------------
+  if (idle_.size() < max_idle_) {
+    object->reset();
+    idle_.push_back(object);
+  }
+  else delete object;
+}
+
+/**
+ * @brief A request handed out by the pool of the calling thread
+ */
+using Pooled_request = Pool<Request>::Handle;
+
+/**
+ * @brief A response handed out by the pool of the calling thread
+ */
+using Pooled_response = Pool<Response>::Handle;
+
+/**
+ * @brief Parse a request into a recycled request object
+ *
+ * @param request:
+ * The bytes of the request
+ *
+ * @return The parsed request, given back to the pool when
+ * it is destroyed
+ */
+inline Pooled_request acquire_request(std::string_view request) {
+  auto object = Pool<Request>::local().acquire();
+  object->parse(request);
+  return object;
+}
+
+/**
+ * @brief Parse a request in a receive buffer into a recycled
+ * request object
+ *
+ * @param buf:
+ * The receive buffer
+ *
+ * @param len:
+ * The number of valid bytes in the buffer
+ *
+ * @return The parsed request, given back to the pool when
+ * it is destroyed
+ */
+inline Pooled_request acquire_request(buffer_t buf, const size_t len) {
+  return acquire_request({reinterpret_cast<const char*>(buf.get()), len});
+}
+
+/**
+ * @brief Get a recycled response object
+ *
+ * @param code:
+ * The status code
+ *
+ * @return The response, given back to the pool when it
+ * is destroyed
+ */
+inline Pooled_response acquire_response(const status_t code = OK) {
+  auto object = Pool<Response>::local().acquire();
+  object->set_status_code(code);
+  return object;
+}
+
+/**--^----------- Implementation Details -----------^--**/
+
+} //< namespace http
+
+#endif //< HTTP_POOL_HPP
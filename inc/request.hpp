@@ -18,6 +18,8 @@
 #ifndef HTTP_REQUEST_HPP
 #define HTTP_REQUEST_HPP
 
+#include <cstring>
+
 #include "message.hpp"
 #include "request_line.hpp"
 
@@ -38,17 +40,40 @@ public:
    */
   explicit Request() = default;
 
+  /**
+   * @brief Construct a default request message whose header
+   * section and body are allocated from a memory resource
+   *
+   * @param resource:
+   * The memory resource, which must outlive this object
+   */
+  explicit Request(std::pmr::memory_resource* resource) noexcept;
+
   /**
    * @brief Construct a request message from the
    * incoming character stream of data which is
    * a {std::string} object
    *
+   * The entity is delimited by its framing fields alone, as
+   * RFC 7230 §3.3.3 describes: a chunked {Transfer-Encoding}, then
+   * {Content-Length}; a request with neither has no entity
+   *
    * @tparam T request:
    * The character stream of data
    *
    * @param limit:
    * Capacity of how many fields can be added to
    * the header section
+   *
+   * @param resource:
+   * The memory resource the header section and body are
+   * allocated from, which must outlive this object
+   *
+   * @note Throws {Header_limit_error} if the request-target or the
+   * header section exceeds the header limits, {Message_error} if a
+   * field line is malformed, the framing fields are invalid or the
+   * entity is shorter than they say, and {Chunked_error} if a chunked
+   * entity is malformed or incomplete
    */
   template
   <
@@ -58,7 +83,8 @@ public:
                <std::string, std::remove_const_t
                <std::remove_reference_t<T>>>::value>
   >
-  explicit Request(T&& request, const Limit limit = 25);
+  explicit Request(T&& request, const Limit limit = 25,
+                   std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
   /**
    * @brief Default copy constructor
@@ -178,6 +204,54 @@ public:
   >
   std::string post_value(T&& name) const noexcept;
 
+  /**
+   * @brief Replace the contents of this request with a request
+   * parsed from a range of bytes
+   *
+   * The storage already held by the header section and body is
+   * reused, so a recycled request parses without allocating
+   * beyond what the URI needs
+   *
+   * @param request:
+   * The bytes of the request
+   *
+   * @return The object that invoked this method
+   *
+   * @note Throws {Header_limit_error} if the request-target or the
+   * header section exceeds the header limits of this request, and
+   * as the constructor does if the entity is malformed
+   */
+  Request& parse(std::string_view request);
+
+  /**
+   * @brief Replace the contents of this request with the first
+   * request in a buffer of pipelined requests
+   *
+   * The request is delimited by its framing fields alone: a
+   * request without {Content-Length} or chunked {Transfer-Encoding}
+   * has no entity, so the bytes that follow its header section
+   * belong to the next request. Empty lines ahead of the
+   * request-line are skipped, as RFC 7230 §3.5 allows
+   *
+   * A request found incomplete is resumed by the next call, which
+   * must be given the same bytes followed by those that arrived
+   * since: its head is parsed once and each byte of its entity is
+   * copied once
+   *
+   * @param buffer:
+   * The received bytes, starting at a request
+   *
+   * @return The number of bytes taken by the request, or 0 if the
+   * buffer only holds the start of it, in which case the contents
+   * of this request are unspecified
+   *
+   * @note Throws {Header_limit_error} if the request exceeds the
+   * header limits of this request, {Message_error} if a field line
+   * is malformed or its framing fields are invalid or conflict, and
+   * {Chunked_error} if its chunked entity is malformed
+   */
+  std::size_t parse_next(std::string_view buffer);
+
   /**
    * @brief Reset the request message as if it was now
    * default constructed
@@ -187,12 +261,32 @@ public:
   virtual Request& reset() noexcept override;
 
   /**
-   * @brief Get a string representation of this
-   * class
+   * @brief Get the number of bytes written by {serialize_into}
+   *
+   * @return The exact serialized size of the request
+   */
+  virtual std::size_t serialized_size() const override;
+
+  /**
+   * @brief Write the request-line, header section and body
+   * in a single pass
+   *
+   * @param out:
+   * Where to write, with room for {serialized_size()} bytes
+   *
+   * @return Pointer past the last byte written
+   */
+  virtual char* serialize_into(char* out) const override;
+
+  /**
+   * @brief Write the request-line, header section and body piece
+   * by piece, handing each part of the body over in the form it
+   * is held in
    *
-   * @return A string representation
+   * @param out:
+   * Where to write
    */
-  virtual std::string to_string() const override;
+  virtual void write_to(Writer& out) const override;
 
   /**
    * @brief Operator to transform this class
@@ -202,24 +296,122 @@ public:
 private:
   //----------------------------------------
   // Class data members
-  Request_line request_line_;
+  Request_line  request_line_;
+  std::size_t   pending_ {0}; //< Offset of the entity of a request {parse_next} found incomplete
+  Body_progress progress_;    //< Progress through that entity
   //----------------------------------------
+
+  /**
+   * @brief Parse the request-line and header section into
+   * this request
+   *
+   * @param request:
+   * The bytes of the request
+   *
+   * @return Offset of the entity within the request
+   */
+  std::size_t parse_head(std::string_view request);
+
+  /**
+   * @brief Parse the request-line, header section and body
+   * into this request
+   *
+   * @param request:
+   * The bytes of the request
+   *
+   * @return Offset past the request, or {incomplete} if the
+   * bytes end before its entity does
+   */
+  std::size_t parse_from(std::string_view request);
 }; //< class Request
 
 /**--v----------- Implementation Details -----------v--**/
 
+inline Request::Request(std::pmr::memory_resource* resource) noexcept
+  : Message{25, resource}
+{}
+
 template <typename Ingress, typename>
-inline Request::Request(Ingress&& request, const Limit limit)
-  : Message{limit}
-  , request_line_{request}
+inline Request::Request(Ingress&& request, const Limit limit, std::pmr::memory_resource* resource)
+  : Message{limit, resource}
 {
-  add_headers(request);
-  std::size_t start_of_body;
-  if ((start_of_body = request.find("\r\n\r\n")) not_eq std::string::npos) {
-    add_body(request.substr(start_of_body + 4));
-  } else if ((start_of_body = request.find("\n\n")) not_eq std::string::npos) {
-    add_body(request.substr(start_of_body + 2));
+  check_complete(parse_from(request));
+}
+
+inline std::size_t Request::parse_from(std::string_view request) {
+  return add_body_from(request, parse_head(request), false);
+}
+
+inline std::size_t Request::parse_head(std::string_view request) {
+  const char* const begin = request.data();
+  const char* const end   = begin + request.size();
+  //-----------------------------------
+  Request_line_parts parts;
+  auto start_of_headers = parse_request_line(begin, end, parts);
+  //-----------------------------------
+  const auto line = get_header_limits().line;
+  if (parts.target.size() > line) {
+    throw Header_limit_error {"Request-target exceeds " + std::to_string(line) + " bytes", URI_Too_Long};
+  }
+  //-----------------------------------
+  request_line_.set_method(parts.method);
+  request_line_.set_uri(URI{std::string{parts.target}});
+  request_line_.set_version(Version{parts.major, parts.minor});
+  //-----------------------------------
+  return add_headers(start_of_headers, end) - begin;
+}
+
+inline Request& Request::parse(std::string_view request) {
+  Message::reset();
+  pending_ = 0;
+  check_complete(parse_from(request));
+  return *this;
+}
+
+inline std::size_t Request::parse_next(std::string_view buffer) {
+  std::size_t skipped {0};
+  while (skipped < buffer.size() and (buffer[skipped] == '\n'
+         or (buffer[skipped] == '\r' and skipped + 1 < buffer.size() and buffer[skipped + 1] == '\n')))
+  {
+    skipped += (buffer[skipped] == '\r') ? 2 : 1;
   }
+  //-----------------------------------
+  const auto request = buffer.substr(skipped);
+  //-----------------------------------
+  if (pending_ == 0) {
+    // The head ends with an empty line, the line-endings being
+    // CRLF or a bare LF as for the header section
+    const char* const end = request.data() + request.size();
+    const char* cursor    = request.data();
+    bool complete {false};
+    //-----------------------------------
+    while (auto eol = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor))) {
+      cursor = eol + 1;
+      if (cursor < end and *cursor == '\r') ++cursor;
+      if (cursor < end and *cursor == '\n') {
+        complete = true;
+        break;
+      }
+    }
+    //-----------------------------------
+    if (not complete) {
+      const auto& limits = get_header_limits();
+      if (request.size() > limits.line + limits.total) {
+        throw Header_limit_error {"Request head exceeds " + std::to_string(limits.line + limits.total) + " bytes"};
+      }
+      return 0;
+    }
+    //-----------------------------------
+    Message::reset();
+    progress_.reset();
+    pending_ = parse_head(request);
+  }
+  //-----------------------------------
+  const auto end = add_body_from(request, pending_, false, progress_);
+  if (end == incomplete) return 0;
+  //-----------------------------------
+  pending_ = 0;
+  return skipped + end;
 }
 
 inline Method Request::method() const noexcept {
@@ -260,9 +452,9 @@ inline std::string Request::post_value(Name&& name) const noexcept {
     return std::string{};
   }
   //---------------------------------
-  auto target = get_body().find(std::forward<Name>(name));
+  auto target = get_body().find(name);
   //---------------------------------
-  if (target == std::string::npos) return std::string{};
+  if (target == std::string_view::npos) return std::string{};
   //---------------------------------
   auto focal_point = get_body().substr(target);
   //---------------------------------
@@ -270,25 +462,37 @@ inline std::string Request::post_value(Name&& name) const noexcept {
   //---------------------------------
   auto lock_and_load = focal_point.find('=');
   //---------------------------------
-  if (lock_and_load == std::string::npos) return std::string{};
+  if (lock_and_load == std::string_view::npos) return std::string{};
   //---------------------------------
-  return focal_point.substr(lock_and_load + 1);
+  return std::string{focal_point.substr(lock_and_load + 1)};
 }
 
 inline Request& Request::reset() noexcept {
+  static const URI root {"/"};
+  //-----------------------------------
   Message::reset();
+  set_header_limits(Header_limits{});
+  pending_ = 0;
   return set_method(GET)
-        .set_uri("/")
+        .set_uri(root)
         .set_version(Version{1,1});
 }
 
-inline std::string Request::to_string() const {
-  std::ostringstream req;
-  //-----------------------------
-  req << request_line_
-      << Message::to_string();
-  //------------------------------
-  return req.str();
+inline std::size_t Request::serialized_size() const {
+  return request_line_.serialized_size() + Message::serialized_size();
+}
+
+inline char* Request::serialize_into(char* out) const {
+  return Message::serialize_into(request_line_.serialize_into(out));
+}
+
+inline void Request::write_to(Writer& out) const {
+  std::pmr::string head {resource()};
+  head.resize(request_line_.serialized_size() + head_size());
+  serialize_head_into(request_line_.serialize_into(head.data()));
+  //-----------------------------------
+  out.write(head);
+  write_body_to(out);
 }
 
 inline Request::operator std::string () const {
@@ -299,6 +503,41 @@ inline Request_ptr make_request(buffer_t buf, const size_t len) {
   return std::make_unique<Request>(std::string{reinterpret_cast<char*>(buf.get()), len});
 }
 
+/**
+ * @brief Split a receive buffer into the complete requests it holds,
+ * as sent by a client that pipelines requests on one connection
+ *
+ * Each request is parsed in turn into the same request object and
+ * handed to the handler, which moves it away to keep it
+ *
+ * @param buffer:
+ * The received bytes, starting at a request
+ *
+ * @param on_request:
+ * Called as {on_request(Request&)} for each complete request
+ *
+ * @return The number of bytes taken by the complete requests; the
+ * rest of the buffer is the start of a request still arriving and
+ * is to be kept until more bytes are received
+ *
+ * @note Throws as {Request::parse_next} does
+ */
+template <typename Handler>
+inline std::size_t split_requests(std::string_view buffer, Handler&& on_request) {
+  Request request;
+  std::size_t offset {0};
+  //-----------------------------------
+  while (offset < buffer.size()) {
+    const auto length = request.parse_next(buffer.substr(offset));
+    if (length == 0) break;
+    //-----------------------------------
+    offset += length;
+    on_request(request);
+  }
+  //-----------------------------------
+  return offset;
+}
+
 inline std::ostream& operator << (std::ostream& output_device, const Request& req) {
   return output_device << req.to_string();
 }
@@ -18,8 +18,9 @@
 #ifndef HTTP_REQUEST_LINE_HPP
 #define HTTP_REQUEST_LINE_HPP
 
-#include <regex>
-#include <cctype>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
 
 #include "common.hpp"
 #include "methods.hpp"
@@ -135,6 +136,31 @@ public:
    */
   void set_version(const Version version) noexcept;
 
+  /**
+   * @brief Get the number of bytes written by {serialize_into}
+   *
+   * @return The serialized size including the trailing CRLF
+   */
+  std::size_t serialized_size() const;
+
+  /**
+   * @brief Write the request-line including the trailing CRLF
+   *
+   * @param out:
+   * Where to write, with room for {serialized_size()} bytes
+   *
+   * @return Pointer past the last byte written
+   */
+  char* serialize_into(char* out) const;
+
+  /**
+   * @brief Append the request-line to a string
+   *
+   * @param out:
+   * The string to append to
+   */
+  void append_to(std::string& out) const;
+
   /**
    * @brief Get a string representation of this
    * class
@@ -161,63 +187,164 @@ private:
 /**
  * @brief This class is used to represent an error that occurred
  * from within the operations of class Request_line
+ *
+ * Errors raised while parsing carry the byte offset at which the
+ * input stopped matching the {Request-Line} grammar
  */
 class Request_line_error : public std::runtime_error {
+public:
   using runtime_error::runtime_error;
+
+  /**
+   * @brief Constructor
+   *
+   * @param what:
+   * A description of the error
+   *
+   * @param offset:
+   * The byte offset into the input where the error was detected
+   */
+  explicit Request_line_error(const std::string& what, const std::size_t offset)
+    : runtime_error{what + " (at byte " + std::to_string(offset) + ')'}
+    , offset_{offset}
+  {}
+
+  /**
+   * @brief Get the byte offset into the input where the error
+   * was detected
+   *
+   * @return The byte offset of the error
+   */
+  std::size_t offset() const noexcept
+  { return offset_; }
+private:
+  std::size_t offset_ {0};
 };
 
-/**--v----------- Implementation Details -----------v--**/
+/**
+ * @brief The components of a {Request-Line} as located in
+ * the input by {parse_request_line}
+ *
+ * The views point into the parsed bytes
+ */
+struct Request_line_parts {
+  Method           method {INVALID};
+  std::string_view method_token;
+  std::string_view target;
+  std::string_view version_token;
+  unsigned         major {0};
+  unsigned         minor {0};
+};
 
-template <typename T, typename>
-inline Request_line::Request_line(T&& request) {
-  if (request.empty() or request.size() < 15 /*<-(15) minimum request length */) {
-    throw Request_line_error("Invalid request");
+/**
+ * @brief Parse a {Request-Line} in a single pass over the input
+ *
+ * Accepts: *WSP method SP request-target SP "HTTP/" 1*DIGIT "." 1*DIGIT
+ * terminated by either CRLF or LF
+ *
+ * Should identify strings according to RFC 2616 sect.5.1
+ * https://tools.ietf.org/html/rfc2616#section-5.1
+ *
+ * @param begin:
+ * The start of the input
+ *
+ * @param end:
+ * The end of the input
+ *
+ * @param parts:
+ * Receives the components of the {Request-Line}
+ *
+ * @return Pointer to the first byte after the line-ending
+ *
+ * @note Throws {Request_line_error} carrying the byte offset of the
+ * first byte that does not match the grammar
+ */
+inline const char* parse_request_line(const char* const begin, const char* const end,
+                                      Request_line_parts& parts)
+{
+  if ((end - begin) < 15 /*<-(15) minimum request length */) {
+    throw Request_line_error {"Invalid request"};
   }
 
-  bool is_canonical_line_ending {false};
+  const char* cursor = begin;
 
-  // Extract {Request-Line} from request
-  std::string request_line;
-  std::size_t index;
-
-  if ((index = request.find("\r\n")) not_eq std::string::npos) {
-    request_line = request.substr(0, index);
-    is_canonical_line_ending = true;
-  } else if ((index = request.find('\n')) not_eq std::string::npos) {
-    request_line = request.substr(0, index);
-  } else {
-    throw Request_line_error("Invalid line-ending");
-  }
+  auto fail = [begin, &cursor](const char* reason) {
+    throw Request_line_error {reason, static_cast<std::size_t>(cursor - begin)};
+  };
 
-  // Should identify strings according to RFC 2616 sect.5.1
-  // https://tools.ietf.org/html/rfc2616#section-5.1
-  const static std::regex request_line_pattern
-  {
-    "\\s*(GET|POST|PUT|DELETE|OPTIONS|HEAD|TRACE|CONNECT) " // Method
-    "(\\S+) " // URI
-    "HTTP/(\\d+)\\.(\\d+)" // Version Major.Minor
+  auto read_number = [&]() {
+    unsigned value {0};
+    const char* const first = cursor;
+    while (cursor < end and *cursor >= '0' and *cursor <= '9') {
+      if (cursor - first == 9) fail("Version number too large");
+      value = (value * 10) + static_cast<unsigned>(*cursor++ - '0');
+    }
+    if (cursor == first) fail("Invalid version");
+    return value;
   };
 
-  std::smatch m;
+  while (cursor < end and (*cursor == ' ' or *cursor == '\t' or *cursor == '\v' or *cursor == '\f')) {
+    ++cursor;
+  }
+
+  // Method
+  const char* const token = cursor;
+  while (cursor < end and method::is_tchar(*cursor)) ++cursor;
+  parts.method_token = {token, static_cast<std::size_t>(cursor - token)};
+  parts.method       = method::code(parts.method_token);
 
-  if (not std::regex_match(request_line, m, request_line_pattern)) {
-    throw Request_line_error("Invalid request line: " + request_line);
+  if (parts.method == INVALID) {
+    cursor = token;
+    fail("Invalid method");
   }
 
-  method_ = method::code(m[1]);
+  if (cursor == end or *cursor not_eq ' ') fail("Expected SP after method");
+  ++cursor;
+
+  // Request-target
+  const char* const target = cursor;
+  while (cursor < end and static_cast<unsigned char>(*cursor) > ' ' and *cursor not_eq '\x7f') ++cursor;
+  parts.target = {target, static_cast<std::size_t>(cursor - target)};
 
-  new (&uri_) URI(m[2]);
+  if (parts.target.empty()) fail("Invalid request-target");
+  if (cursor == end or *cursor not_eq ' ') fail("Expected SP after request-target");
+  ++cursor;
 
-  unsigned maj = static_cast<unsigned>(std::stoul(m[3]));
-  unsigned min = static_cast<unsigned>(std::stoul(m[4]));
-  version_ = Version{maj, min};
+  // HTTP-version
+  const char* const version = cursor;
+  if ((end - cursor) < 5 or std::memcmp(cursor, "HTTP/", 5) not_eq 0) fail("Invalid version");
+  cursor += 5;
+
+  parts.major = read_number();
+  if (cursor == end or *cursor not_eq '.') fail("Invalid version");
+  ++cursor;
+  parts.minor = read_number();
+
+  parts.version_token = {version, static_cast<std::size_t>(cursor - version)};
+
+  // Line-ending
+  if (cursor < end and *cursor == '\r') ++cursor;
+  if (cursor == end) throw Request_line_error {"Invalid line-ending"};
+  if (*cursor not_eq '\n') fail("Expected line-ending after version");
+
+  return cursor + 1;
+}
+
+/**--v----------- Implementation Details -----------v--**/
+
+template <typename T, typename>
+inline Request_line::Request_line(T&& request) {
+  Request_line_parts parts;
+
+  auto data = request.data();
+  auto next = parse_request_line(data, data + request.size(), parts);
+
+  method_  = parts.method;
+  uri_     = URI{std::string{parts.target}};
+  version_ = Version{parts.major, parts.minor};
 
   // Trim the request for further processing
-  if (is_canonical_line_ending) {
-    request = request.substr(index + 2);
-  } else {
-    request = request.substr(index + 1);
-  }
+  request.erase(0, next - data);
 }
 
 inline Method Request_line::get_method() const noexcept {
@@ -237,7 +364,7 @@ inline const URI& Request_line::get_uri() const noexcept {
 }
 
 inline void Request_line::set_uri(const URI& uri) {
-  new (&uri_) URI(uri);
+  uri_ = uri;
 }
 
 inline Version Request_line::get_version() const noexcept {
@@ -248,14 +375,37 @@ inline void Request_line::set_version(const Version version) noexcept {
   version_ = version;
 }
 
+inline std::size_t Request_line::serialized_size() const {
+  const auto& target = uri_.to_string();
+  //----------------------------
+  return method::str(method_).size() + 1
+       + target.size()               + 1
+       + version_.serialized_size()  + 2;
+}
+
+inline char* Request_line::serialize_into(char* out) const {
+  const auto& target = uri_.to_string();
+  //----------------------------
+  out    = format::write(out, method::str(method_));
+  *out++ = ' ';
+  out    = format::write(out, target);
+  *out++ = ' ';
+  out    = version_.serialize_into(out);
+  return format::write(out, "\r\n");
+}
+
+inline void Request_line::append_to(std::string& out) const {
+  const auto size = out.size();
+  out.resize(size + serialized_size());
+  serialize_into(&out[size]);
+}
+
 inline std::string Request_line::to_string() const {
-  std::ostringstream req_line;
+  std::string req_line;
   //----------------------------
-  req_line << method::str(method_) << " "
-           << uri_                 << " "
-           << version_             << "\r\n";
+  append_to(req_line);
   //-----------------------------
-  return req_line.str();
+  return req_line;
 }
 
 inline Request_line::operator std::string () const {
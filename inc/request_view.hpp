@@ -0,0 +1,459 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_REQUEST_VIEW_HPP
+#define HTTP_REQUEST_VIEW_HPP
+
+#include <array>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#include "request.hpp"
+
+namespace http {
+
+/**
+ * @brief This class is a read-only view of an HTTP request
+ * message which is parsed in place over the bytes of a receive
+ * buffer
+ *
+ * Every component (method, target, version, header fields and
+ * body) is exposed as a {std::string_view} into the underlying
+ * bytes, so no allocation or copying takes place while parsing
+ *
+ * The body is delimited by its framing fields alone, as for
+ * {Request}: {Content-Length} bytes, or none without the field.
+ * A chunked body is left to the caller to decode from {consumed},
+ * so the bytes of a pipelined request never join the body
+ *
+ * The underlying bytes must outlive the view unless the view was
+ * constructed from a {buffer_t}, in which case the view shares
+ * ownership of the buffer
+ */
+class Request_view {
+public:
+  /**
+   * @brief A header field as it appears in the buffer
+   *
+   * Folded values span the raw bytes of all continuation lines
+   */
+  struct Field {
+    std::string_view name;
+    std::string_view value;
+  };
+private:
+  //----------------------------------------
+  // Internal class type aliases
+  using Field_set      = std::array<Field, Header_limits{}.fields>;
+  using Const_iterator = Field_set::const_iterator;
+  //----------------------------------------
+public:
+  /**
+   * @brief Parse a request in place over a range of bytes
+   *
+   * @param data:
+   * The start of the request bytes
+   *
+   * @param len:
+   * The number of bytes in the request
+   *
+   * @note Throws {Request_line_error} if the request line is malformed
+   * @note Throws {Request_view_error} if the header section is malformed,
+   * holds more fields than the default {Header_limits} allow or has
+   * invalid or conflicting framing fields
+   */
+  explicit Request_view(const char* data, const std::size_t len);
+
+  /**
+   * @brief Parse a request in place over a receive buffer
+   *
+   * The view keeps a reference to the buffer so the
+   * views it hands out stay valid for its lifetime
+   *
+   * @param buf:
+   * The receive buffer
+   *
+   * @param len:
+   * The number of valid bytes in the buffer
+   */
+  explicit Request_view(buffer_t buf, const std::size_t len);
+
+  /**
+   * @brief Get the method token of the request
+   *
+   * @return The method token
+   */
+  std::string_view method() const noexcept
+  { return method_; }
+
+  /**
+   * @brief Get the request-target of the request
+   *
+   * @return The request-target
+   */
+  std::string_view target() const noexcept
+  { return target_; }
+
+  /**
+   * @brief Get the HTTP-version of the request, e.g. "HTTP/1.1"
+   *
+   * @return The HTTP-version
+   */
+  std::string_view version() const noexcept
+  { return version_; }
+
+  /**
+   * @brief Get the number of header fields in the request
+   *
+   * @return The number of header fields
+   */
+  Limit header_size() const noexcept
+  { return size_; }
+
+  /**
+   * @brief Iterator to the first header field
+   */
+  Const_iterator begin() const noexcept
+  { return fields_.cbegin(); }
+
+  /**
+   * @brief Iterator past the last header field
+   */
+  Const_iterator end() const noexcept
+  { return fields_.cbegin() + size_; }
+
+  /**
+   * @brief Check if the specified field is within
+   * the request
+   *
+   * @param field:
+   * The field name to search for (case-insensitive)
+   *
+   * @return true if present, false otherwise
+   */
+  bool has_header(std::string_view field) const noexcept;
+
+  /**
+   * @brief Get the value associated with the
+   * specified field name
+   *
+   * @param field:
+   * The field name to search for (case-insensitive)
+   *
+   * @return The associated value if the field was found,
+   * an empty view otherwise
+   */
+  std::string_view header_value(std::string_view field) const noexcept;
+
+  /**
+   * @brief Get the message body of the request
+   *
+   * @return The bytes after the blank line that ends the header
+   * section up to its {Content-Length}, fewer if the bytes end
+   * first, and none for a request without the field or a chunked one
+   */
+  std::string_view body() const noexcept
+  { return body_; }
+
+  /**
+   * @brief Check if the body is in the chunked transfer coding,
+   * in which case it starts at {consumed} and is not part of {body}
+   *
+   * @return true if the body is chunked, false otherwise
+   */
+  bool is_chunked() const noexcept
+  { return chunked_; }
+
+  /**
+   * @brief Get the number of bytes of the request within the
+   * underlying bytes
+   *
+   * @return The size of the head and {body}; the bytes past it
+   * belong to a chunked body or to the next request
+   */
+  std::size_t consumed() const noexcept
+  { return consumed_; }
+
+  /**
+   * @brief Copy the request into an owning {Request} object
+   *
+   * Only handlers that need to keep the request beyond the
+   * lifetime of the buffer should pay for this
+   *
+   * @param limit:
+   * Capacity of how many fields can be added to
+   * the header section
+   *
+   * @return An owning copy of the request
+   */
+  Request to_request(const Limit limit = Header_limits{}.fields) const;
+private:
+  //----------------------------------------
+  // Class data members
+  buffer_t         buffer_;
+  std::string_view method_;
+  std::string_view target_;
+  std::string_view version_;
+  std::string_view body_;
+  Method           method_code_ {INVALID};
+  Version          version_code_;
+  Field_set        fields_;
+  Limit            size_ {0};
+  std::size_t      consumed_ {0};
+  bool             chunked_ {false};
+  //----------------------------------------
+
+  /**
+   * @brief Parse the request line, header section and locate
+   * the body
+   */
+  void parse(const char* begin, const char* end);
+
+  /**
+   * @brief Get the length of the body from the framing fields
+   *
+   * @return The length of the body, 0 if it has none or is chunked
+   */
+  std::size_t framed_length();
+
+  /**
+   * @brief Find the location of a field within the set of
+   * fields
+   */
+  Const_iterator find(std::string_view field) const noexcept;
+
+}; //< class Request_view
+
+/**
+ * @brief This class is used to represent an error that occurred
+ * from within the operations of class Request_view
+ */
+class Request_view_error : public std::runtime_error {
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param what:
+   * A description of the error
+   *
+   * @param code:
+   * The status code to respond with
+   */
+  explicit Request_view_error(const std::string& what, const status_t code = Bad_Request)
+    : runtime_error{what}
+    , code_{code}
+  {}
+
+  /**
+   * @brief Get the status code to respond with
+   *
+   * @return {Bad_Request} or {Request_Header_Fields_Too_Large}
+   */
+  status_t status_code() const noexcept
+  { return code_; }
+private:
+  status_t code_;
+}; //< class Request_view_error
+
+/**--v----------- Implementation Details -----------v--**/
+
+inline Request_view::Request_view(const char* data, const std::size_t len) {
+  parse(data, data + len);
+}
+
+inline Request_view::Request_view(buffer_t buf, const std::size_t len)
+  : buffer_{std::move(buf)}
+{
+  auto data = reinterpret_cast<const char*>(buffer_.get());
+  parse(data, data + len);
+}
+
+inline void Request_view::parse(const char* begin, const char* end) {
+  auto is_space = [](const char c) { return c == ' ' or c == '\t'; };
+
+  Request_line_parts parts;
+  auto cursor = parse_request_line(begin, end, parts);
+  //-----------------------------------
+  method_       = parts.method_token;
+  target_       = parts.target;
+  version_      = parts.version_token;
+  version_code_ = Version{parts.major, parts.minor};
+  method_code_  = parts.method;
+  //-----------------------------------
+  // Header section: one line at a time until the empty line
+  while (cursor < end) {
+    auto eol      = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+    auto line_end = (eol == nullptr) ? end : eol;
+    auto next     = (eol == nullptr) ? end : eol + 1;
+    if (line_end > cursor and *(line_end - 1) == '\r') --line_end;
+
+    if (line_end == cursor) { cursor = next; break; }
+
+    // A line-ending is CRLF or a bare LF, as for {Header}
+    if (std::memchr(cursor, '\r', line_end - cursor) not_eq nullptr) {
+      throw Request_view_error {"Bare CR in header section"};
+    }
+
+    // obs-fold: the continuation belongs to the previous value
+    if (is_space(*cursor) and size_ > 0) {
+      auto& value = fields_[size_ - 1].value;
+      auto  tail  = line_end;
+      while (tail > cursor and is_space(*(tail - 1))) --tail;
+      if (tail > cursor) {
+        value = {value.data(), static_cast<std::size_t>(tail - value.data())};
+      }
+      cursor = next;
+      continue;
+    }
+
+    auto colon = static_cast<const char*>(std::memchr(cursor, ':', line_end - cursor));
+    if (colon == nullptr or not is_field_name({cursor, static_cast<std::size_t>(colon - cursor)})) {
+      throw Request_view_error {"Invalid header field: " + std::string{cursor, line_end}};
+    }
+
+    auto value_begin = colon + 1;
+    while (value_begin < line_end and is_space(*value_begin)) ++value_begin;
+    auto value_end = line_end;
+    while (value_end > value_begin and is_space(*(value_end - 1))) --value_end;
+
+    // Dropping a field could hide one that frames the body
+    if (size_ == fields_.size()) {
+      throw Request_view_error {"Header section exceeds " + std::to_string(fields_.size()) + " fields",
+                                Request_Header_Fields_Too_Large};
+    }
+    fields_[size_++] = {
+      {cursor, static_cast<std::size_t>(colon - cursor)},
+      {value_begin, static_cast<std::size_t>(value_end - value_begin)}
+    };
+
+    cursor = next;
+  }
+
+  const auto length = std::min(framed_length(), static_cast<std::size_t>(end - cursor));
+  body_     = {cursor, length};
+  consumed_ = static_cast<std::size_t>(cursor - begin) + length;
+}
+
+inline std::size_t Request_view::framed_length() {
+  std::size_t length {0};
+  bool has_length {false};
+  //-----------------------------------
+  for (const auto& field : *this) {
+    const Header_id id = header_fields::id(field.name);
+    //-----------------------------------
+    if (id == Header_id::Transfer_Encoding) {
+      // Only a body whose final coding is chunked can be delimited
+      if (not http::is_chunked(field.value)) throw Request_view_error {"Unsupported Transfer-Encoding"};
+      chunked_ = true;
+      continue;
+    }
+    //-----------------------------------
+    if (id not_eq Header_id::Content_Length) continue;
+    //-----------------------------------
+    if (field.value.empty() or field.value.size() > 18) throw Request_view_error {"Invalid Content-Length"};
+    //-----------------------------------
+    std::size_t value {0};
+    for (const char c : field.value) {
+      if (c < '0' or c > '9') throw Request_view_error {"Invalid Content-Length"};
+      value = (value * 10) + static_cast<std::size_t>(c - '0');
+    }
+    //-----------------------------------
+    if (has_length and value not_eq length) throw Request_view_error {"Conflicting Content-Length fields"};
+    //-----------------------------------
+    has_length = true;
+    length     = value;
+  }
+  //-----------------------------------
+  // A message with both is how requests are smuggled past proxies
+  if (chunked_ and has_length) throw Request_view_error {"Both Transfer-Encoding and Content-Length"};
+  //-----------------------------------
+  return chunked_ ? 0 : length;
+}
+
+inline bool Request_view::has_header(std::string_view field) const noexcept {
+  return find(field) not_eq end();
+}
+
+inline std::string_view Request_view::header_value(std::string_view field) const noexcept {
+  auto target = find(field);
+  return (target not_eq end()) ? target->value : std::string_view{};
+}
+
+inline Request_view::Const_iterator Request_view::find(std::string_view field) const noexcept {
+  if (field.empty()) return end();
+  //-----------------------------------
+  return
+  std::find_if(begin(), end(), [field](const auto& f) {
+    return iequals(f.name, field);
+  });
+}
+
+inline Request Request_view::to_request(const Limit limit) const {
+  Request request;
+  request.set_header_limit(limit);
+  //-----------------------------------
+  request.set_method(method_code_)
+         .set_uri(URI{std::string{target_}})
+         .set_version(version_code_);
+  //-----------------------------------
+  // The body goes first, as adding it drops a {Content-Length} field
+  if (not body_.empty()) request.add_body(std::string{body_});
+  //-----------------------------------
+  for (const auto& field : *this) {
+    std::string value;
+    value.reserve(field.value.size());
+    //-----------------------------------
+    // Unfold continuation lines into a single space
+    for (std::size_t i = 0; i < field.value.size(); ++i) {
+      const char c = field.value[i];
+      if (c == '\r' or c == '\n') {
+        while (i + 1 < field.value.size() and std::isspace(static_cast<unsigned char>(field.value[i + 1]))) ++i;
+        value += ' ';
+      } else {
+        value += c;
+      }
+    }
+    //-----------------------------------
+    request.add_header(std::string{field.name}, std::move(value));
+  }
+  //-----------------------------------
+  return request;
+}
+
+/**
+ * @brief Parse a request in place over a receive buffer
+ *
+ * @param buf:
+ * The receive buffer
+ *
+ * @param len:
+ * The number of valid bytes in the buffer
+ *
+ * @return A view of the request which shares ownership of
+ * the buffer
+ */
+inline Request_view make_request_view(buffer_t buf, const size_t len) {
+  return Request_view{std::move(buf), len};
+}
+
+/**--^----------- Implementation Details -----------^--**/
+
+} //< namespace http
+
+#endif //< HTTP_REQUEST_VIEW_HPP
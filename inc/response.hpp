@@ -18,7 +18,10 @@
 #ifndef HTTP_RESPONSE_HPP
 #define HTTP_RESPONSE_HPP
 
+#include <vector>
+
 #include "message.hpp"
+#include "methods.hpp"
 #include "status_line.hpp"
 
 namespace http {
@@ -34,6 +37,123 @@ private:
   using Code  = status_t;
   //------------------------------
 public:
+  /**
+   * @brief A contiguous run of bytes to be written, laid out
+   * like a POSIX {struct iovec} so a set of segments can be
+   * handed to {writev} as is
+   */
+  struct Segment {
+    const void* base;
+    std::size_t length;
+  };
+
+  /**
+   * @brief The segments of a serialized response in the order
+   * they are written: status-line, header section and body, the
+   * body taking one segment per chunk of a rope
+   */
+  using Segments = std::pmr::vector<Segment>;
+
+  /**
+   * @brief The body of a response being sent in the chunked
+   * transfer coding, obtained from {stream} once the status-line
+   * and header section are written
+   *
+   * Each piece written goes out as one chunk right away, so a
+   * body of unknown length never needs to be held at once. The
+   * body must be ended with {finish}, after adding any trailer
+   * fields
+   */
+  class Stream {
+  public:
+    /**
+     * @brief Write the next piece of the body as one chunk
+     *
+     * @param piece:
+     * The bytes to write, an empty piece being ignored
+     *
+     * @return The object that invoked this method
+     *
+     * @note Throws {Chunked_error} if the body was finished
+     */
+    Stream& write(std::string_view piece);
+
+    /**
+     * @brief Write a body as the next pieces of the body, in the
+     * form it is held in
+     *
+     * @param body:
+     * The body to write
+     *
+     * @return The object that invoked this method
+     *
+     * @note Throws {Chunked_error} if the body was finished
+     */
+    Stream& write(const Body& body);
+
+    /**
+     * @brief Add a trailer field, sent after the body by {finish}
+     *
+     * @tparam F field:
+     * The name of the field
+     *
+     * @tparam V value:
+     * The value of the field
+     *
+     * @return The object that invoked this method
+     *
+     * @note Throws {Chunked_error} if the field frames the message,
+     * and {Header_limit_error} if it exceeds the limits of the
+     * trailer section
+     */
+    template <typename F, typename V>
+    Stream& add_trailer(F&& field, V&& value);
+
+    /**
+     * @brief Get the trailer fields added so far
+     *
+     * @return The trailer section
+     */
+    const Header& trailers() const noexcept
+    { return trailers_; }
+
+    /**
+     * @brief End the body, followed by the trailer fields
+     *
+     * @note Throws {Chunked_error} if the body was finished
+     */
+    void finish();
+
+    /**
+     * @brief Check if the body was ended
+     *
+     * @return true if {finish} was called, false otherwise
+     */
+    bool finished() const noexcept
+    { return encoder_.finished(); }
+
+    /**
+     * @brief Get the number of body bytes written so far
+     *
+     * @return The number of body bytes written
+     */
+    std::size_t body_size() const noexcept
+    { return encoder_.body_size(); }
+  private:
+    //------------------------------
+    // Class data members
+    Chunked_encoder encoder_;
+    Header          trailers_;
+    //------------------------------
+
+    /**
+     * @brief Constructor, only a response starts a stream
+     */
+    Stream(Writer& out, std::pmr::memory_resource* resource);
+
+    friend class Response;
+  }; //< class Stream
+
   /**
    * @brief Constructor to set up a response
    * by providing information for the
@@ -44,8 +164,13 @@ public:
    *
    * @param version:
    * The version of the message
+   *
+   * @param resource:
+   * The memory resource the header section and body are
+   * allocated from, which must outlive this object
    */
-  explicit Response(const Code code = OK, const Version version = Version{}) noexcept;
+  explicit Response(const Code code = OK, const Version version = Version{},
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept;
 
   /**
    * @brief Construct a response message from the
@@ -57,6 +182,17 @@ public:
    *
    * @param limit:
    * Capacity of how many fields can be added to the header section
+   *
+   * @param resource:
+   * The memory resource the header section and body are
+   * allocated from, which must outlive this object
+   *
+   * @note Throws {Message_error} if a field line is malformed, the
+   * framing fields are invalid or the entity is shorter than they
+   * say, and {Chunked_error} if a chunked entity is malformed or
+   * incomplete
+   *
+   * @see parse for a response to a HEAD request
    */
   template
   <
@@ -66,7 +202,8 @@ public:
                <std::string, std::remove_const_t
                <std::remove_reference_t<T>>>::value>
   >
-  explicit Response(T&& response, const Limit limit = 100);
+  explicit Response(T&& response, const Limit limit = 100,
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
   /**
    * @brief  Default copy constructor
@@ -110,6 +247,26 @@ public:
    */
   Response& set_status_code(const Code code) noexcept;
 
+  /**
+   * @brief Replace the contents of this response with a response
+   * parsed from a range of bytes
+   *
+   * A response to HEAD, and one with a 1xx, 204 or 304 status code,
+   * has no entity whatever its framing fields say (RFC 7230 §3.3.3);
+   * the fields are kept as they were received
+   *
+   * @param response:
+   * The bytes of the response
+   *
+   * @param request_method:
+   * The method of the request the response answers
+   *
+   * @return The object that invoked this method
+   *
+   * @note Throws as the constructor does
+   */
+  Response& parse(std::string_view response, const Method request_method = GET);
+
   /**
    * @brief Reset the response message as if it was now
    * default constructed
@@ -119,12 +276,71 @@ public:
   virtual Response& reset() noexcept override;
   
   /**
-   * @brief Get a string representation of this
-   * class
+   * @brief Get the number of bytes written by {serialize_into}
+   *
+   * @return The exact serialized size of the response
+   */
+  virtual std::size_t serialized_size() const override;
+
+  /**
+   * @brief Write the status-line, header section and body
+   * in a single pass
+   *
+   * @param out:
+   * Where to write, with room for {serialized_size()} bytes
+   *
+   * @return Pointer past the last byte written
+   */
+  virtual char* serialize_into(char* out) const override;
+
+  /**
+   * @brief Write the status-line, header section and body piece
+   * by piece, handing each part of the body over in the form it
+   * is held in
+   *
+   * @param out:
+   * Where to write
+   */
+  virtual void write_to(Writer& out) const override;
+
+  /**
+   * @brief Get the response as segments for scatter-gather
+   * output, without copying the body
+   *
+   * The header section is rendered into a buffer owned by this
+   * response, which is reused by later calls; the status-line
+   * segment refers to the compile-time table of status-lines
+   * when possible and the body segments refer to the body in place.
+   * A body in the chunked transfer coding is framed by a size line
+   * and the last chunk rendered into the same buffer
+   *
+   * The segments are valid until this response is modified,
+   * exported again or destroyed
+   *
+   * @return The segments of the response
+   *
+   * @note Throws {Body_error} if the body is not held in memory,
+   * such a body is written with {write_to}
+   */
+  const Segments& export_iovecs();
+
+  /**
+   * @brief Write the status-line and header section now and send
+   * the body in the chunked transfer coding as it is produced
+   *
+   * {Transfer-Encoding} is set to end with chunked and any
+   * {Content-Length} field is dropped. A body already held by this
+   * response is written as the first pieces of the stream
+   *
+   * The recipient must support HTTP/1.1, as chunked framing does
+   * not exist in HTTP/1.0
+   *
+   * @param out:
+   * Where to write, which must outlive the stream
    *
-   * @return A string representation
+   * @return The stream taking the rest of the body
    */
-  virtual std::string to_string() const override;
+  Stream stream(Writer& out);
 
   /**
    * @brief Operator to transform this class
@@ -136,27 +352,60 @@ private:
   //------------------------------
   // Class data members
   Status_line status_line_;
+  std::pmr::string head_;     //< Rendered header section for {export_iovecs}
+  Segments         segments_; //< Segments handed out by {export_iovecs}
   //------------------------------
+
+  /**
+   * @brief Parse the status-line, header section and body
+   * into this response
+   */
+  void parse_from(std::string_view response, const Method request_method);
 }; //< class Response
 
 /**--v----------- Implementation Details -----------v--**/
 
-inline Response::Response(const Code code, const Version version) noexcept
-  : status_line_{version, code}
+inline Response::Response(const Code code, const Version version, std::pmr::memory_resource* resource) noexcept
+  : Message{25, resource}
+  , status_line_{version, code}
+  , head_{resource}
+  , segments_{resource}
 {}
 
 template <typename Egress, typename>
-inline Response::Response(Egress&& response, const Limit limit)
-  : Message{limit}
-  , status_line_{response}
+inline Response::Response(Egress&& response, const Limit limit, std::pmr::memory_resource* resource)
+  : Message{limit, resource}
+  , status_line_{Version{}, OK}
+  , head_{resource}
+  , segments_{resource}
 {
-  add_headers(response);
-  std::size_t start_of_body;
-  if ((start_of_body = response.find("\r\n\r\n")) not_eq std::string::npos) {
-    add_body(response.substr(start_of_body + 4));
-  } else if ((start_of_body = response.find("\n\n")) not_eq std::string::npos) {
-    add_body(response.substr(start_of_body + 2));
+  parse_from(response, GET);
+}
+
+inline void Response::parse_from(std::string_view response, const Method request_method) {
+  const char* const begin = response.data();
+  const char* const end   = begin + response.size();
+  //-----------------------------------
+  Status_line_parts parts;
+  auto start_of_headers = parse_status_line(begin, end, parts);
+  //-----------------------------------
+  status_line_.set_version(parts.version);
+  status_line_.set_code(parts.code);
+  //-----------------------------------
+  const std::size_t start_of_body = add_headers(start_of_headers, end) - begin;
+  //-----------------------------------
+  const auto code = parts.code;
+  if (request_method == HEAD or (code >= 100 and code < 200) or code == No_Content or code == Not_Modified) {
+    return;
   }
+  //-----------------------------------
+  check_complete(add_body_from(response, start_of_body, true));
+}
+
+inline Response& Response::parse(std::string_view response, const Method request_method) {
+  Message::reset();
+  parse_from(response, request_method);
+  return *this;
 }
 
 inline Response::Code Response::status_code() const noexcept {
@@ -170,16 +419,120 @@ inline Response& Response::set_status_code(const Code code) noexcept {
 
 inline Response& Response::reset() noexcept {
   Message::reset();
+  set_header_limits(Header_limits{});
+  status_line_.set_version(Version{});
   return set_status_code(OK);
 }
 
-inline std::string Response::to_string() const {
-  std::ostringstream res;
+inline std::size_t Response::serialized_size() const {
+  return status_line_.serialized_size() + Message::serialized_size();
+}
+
+inline char* Response::serialize_into(char* out) const {
+  return Message::serialize_into(status_line_.serialize_into(out));
+}
+
+inline void Response::write_to(Writer& out) const {
+  std::pmr::string head {resource()};
+  head.resize(status_line_.serialized_size() + head_size());
+  serialize_head_into(status_line_.serialize_into(head.data()));
+  //-----------------------------------
+  out.write(head);
+  write_body_to(out);
+}
+
+inline const Response::Segments& Response::export_iovecs() {
+  if (not body().in_memory()) {
+    throw Body_error {"Only a body held in memory can be exported as segments"};
+  }
+  //-----------------------------------
+  auto status_line = status_line_.prerendered();
+  //-----------------------------------
+  const std::size_t status_line_size = status_line.empty() ? status_line_.serialized_size() : 0;
+  const std::size_t fields_size      = head_size();
+  //-----------------------------------
+  // A chunked body goes out as a single chunk followed by the last chunk
+  const auto body_size = body().size();
+  const bool chunked   = sends_chunked();
+  const std::size_t size_line = (chunked and body_size > 0) ? format::hex_size(body_size) + 2 : 0;
+  const std::string_view last_chunk = not chunked ? "" : (body_size > 0) ? "\r\n0\r\n\r\n" : "0\r\n\r\n";
+  //-----------------------------------
+  head_.resize(status_line_size + fields_size + size_line + last_chunk.size());
+  //-----------------------------------
+  if (status_line_size not_eq 0) status_line_.serialize_into(head_.data());
+  auto out = serialize_head_into(head_.data() + status_line_size);
+  if (size_line not_eq 0) out = format::write(format::write_hex(out, body_size), "\r\n");
+  format::write(out, last_chunk);
+  //-----------------------------------
+  if (status_line.empty()) status_line = {head_.data(), status_line_size};
+  //-----------------------------------
+  segments_.clear();
+  segments_.push_back({status_line.data(),              status_line.size()});
+  segments_.push_back({head_.data() + status_line_size, fields_size + size_line});
+  //-----------------------------------
+  if (body().kind() == Body::Kind::Rope) {
+    for (const auto& chunk : body().chunks()) segments_.push_back({chunk.data(), chunk.size()});
+  }
+  else {
+    const auto bytes = body().view();
+    segments_.push_back({bytes.data(), bytes.size()});
+  }
+  //-----------------------------------
+  if (not last_chunk.empty()) {
+    segments_.push_back({head_.data() + status_line_size + fields_size + size_line, last_chunk.size()});
+  }
+  //-----------------------------------
+  return segments_;
+}
+
+inline Response::Stream Response::stream(Writer& out) {
+  erase_header(header_fields::Entity::Content_Length);
   //-----------------------------------
-  res << status_line_
-      << Message::to_string();
+  const auto codings = header_value(Header_id::Transfer_Encoding);
+  if (codings.empty()) {
+    set_header(header_fields::General::Transfer_Encoding, "chunked");
+  }
+  else if (not is_chunked(codings)) {
+    set_header(header_fields::General::Transfer_Encoding, std::string{codings} + ", chunked");
+  }
+  //-----------------------------------
+  std::pmr::string head {resource()};
+  head.resize(status_line_.serialized_size() + head_size());
+  serialize_head_into(status_line_.serialize_into(head.data()));
+  out.write(head);
   //-----------------------------------
-  return res.str();
+  Stream stream {out, resource()};
+  stream.write(body());
+  return stream;
+}
+
+inline Response::Stream::Stream(Writer& out, std::pmr::memory_resource* resource)
+  : encoder_{out}
+  , trailers_{25, resource}
+{}
+
+inline Response::Stream& Response::Stream::write(std::string_view piece) {
+  encoder_.write(piece);
+  return *this;
+}
+
+inline Response::Stream& Response::Stream::write(const Body& body) {
+  if (encoder_.finished()) throw Chunked_error {"Chunked body already finished"};
+  body.write_to(encoder_);
+  return *this;
+}
+
+template <typename F, typename V>
+inline Response::Stream& Response::Stream::add_trailer(F&& field, V&& value) {
+  if (is_framing_field(std::string_view{field})) {
+    throw Chunked_error {"Framing field in trailer: " + std::string{std::string_view{field}}};
+  }
+  trailers_.add_field(std::forward<F>(field), std::forward<V>(value));
+  return *this;
+}
+
+inline void Response::Stream::finish() {
+  encoder_.finish(trailers_);
 }
 
 inline Response::operator std::string () const {
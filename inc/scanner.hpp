@@ -0,0 +1,199 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_SCANNER_HPP
+#define HTTP_SCANNER_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_SCANNER_X86 1
+#endif
+
+namespace http {
+namespace scanner {
+
+/**
+ * @brief Number of bytes classified per block
+ */
+constexpr std::size_t block_size {32};
+
+/**
+ * @brief Computes a bit mask of the delimiters (':', '\r' and '\n')
+ * in the {block_size} bytes starting at the specified location,
+ * where bit i is set if byte i is a delimiter
+ */
+using Block_mask = uint32_t (*)(const char* block) noexcept;
+
+/**
+ * @brief Portable fallback
+ */
+inline uint32_t mask_scalar(const char* block) noexcept {
+  uint32_t mask {0};
+  for (std::size_t i = 0; i < block_size; ++i) {
+    const char c = block[i];
+    mask |= static_cast<uint32_t>(c == ':' or c == '\r' or c == '\n') << i;
+  }
+  return mask;
+}
+
+#ifdef HTTP_SCANNER_X86
+
+/**
+ * @brief Two 16-byte compares per block
+ *
+ * Baseline on x86_64 and therefore available on every SSE4.2 part;
+ * for a three-byte delimiter set plain compares beat PCMPESTRM
+ */
+__attribute__((target("sse2")))
+inline uint32_t mask_sse2(const char* block) noexcept {
+  const __m128i colon = _mm_set1_epi8(':');
+  const __m128i cr    = _mm_set1_epi8('\r');
+  const __m128i lf    = _mm_set1_epi8('\n');
+  //-----------------------------------
+  const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+  const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+  //-----------------------------------
+  const __m128i lo_mask = _mm_or_si128(_mm_cmpeq_epi8(lo, colon),
+                          _mm_or_si128(_mm_cmpeq_epi8(lo, cr), _mm_cmpeq_epi8(lo, lf)));
+  const __m128i hi_mask = _mm_or_si128(_mm_cmpeq_epi8(hi, colon),
+                          _mm_or_si128(_mm_cmpeq_epi8(hi, cr), _mm_cmpeq_epi8(hi, lf)));
+  //-----------------------------------
+  return static_cast<uint32_t>(_mm_movemask_epi8(lo_mask))
+       | (static_cast<uint32_t>(_mm_movemask_epi8(hi_mask)) << 16);
+}
+
+/**
+ * @brief One 32-byte compare per block
+ */
+__attribute__((target("avx2")))
+inline uint32_t mask_avx2(const char* block) noexcept {
+  const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+  const __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')),
+                                    _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+}
+
+#endif //< HTTP_SCANNER_X86
+
+/**
+ * @brief Get the best block classifier for the CPU we are running on
+ *
+ * The choice is made once, on first use
+ *
+ * @return The block classifier
+ */
+inline Block_mask best_mask() noexcept {
+  static const Block_mask mask = [] {
+#ifdef HTTP_SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return &mask_avx2;
+    if (__builtin_cpu_supports("sse2")) return &mask_sse2;
+#endif
+    return &mask_scalar;
+  }();
+  return mask;
+}
+
+} //< namespace scanner
+
+/**
+ * @brief This class locates the delimiters of a header section
+ * (':', '\r' and '\n') a block at a time
+ *
+ * Each block of bytes is classified once and the resulting bit mask
+ * is consumed by successive calls to {next}, so a header line costs
+ * a few bit operations rather than a comparison per byte
+ */
+class Delimiter_scanner {
+public:
+  /**
+   * @brief Constructor
+   *
+   * @param begin:
+   * The start of the bytes to scan
+   *
+   * @param end:
+   * The end of the bytes to scan
+   *
+   * @param mask:
+   * The block classifier to use
+   */
+  explicit Delimiter_scanner(const char* begin, const char* end,
+                             scanner::Block_mask mask = scanner::best_mask()) noexcept
+    : end_{end}
+    , block_{begin}
+    , mask_{mask}
+  { load(); }
+
+  /**
+   * @brief Find the next delimiter at or after the specified location
+   *
+   * Locations must not precede the location of a previous call
+   *
+   * @param from:
+   * Where to start looking
+   *
+   * @return Pointer to the delimiter, or the end of the bytes if
+   * there are no more delimiters
+   */
+  const char* next(const char* from) noexcept {
+    while (from < end_) {
+      if (from >= block_ + scanner::block_size) {
+        block_ = from;
+        load();
+      }
+      //-----------------------------------
+      const uint32_t pending = bits_ & (~uint32_t{0} << (from - block_));
+      if (pending not_eq 0) return block_ + __builtin_ctz(pending);
+      //-----------------------------------
+      from = block_ + scanner::block_size;
+    }
+    //-----------------------------------
+    return end_;
+  }
+private:
+  //-----------------------------------
+  // Class data members
+  const char*         end_;
+  const char*         block_;
+  scanner::Block_mask mask_;
+  uint32_t            bits_ {0};
+  //-----------------------------------
+
+  /**
+   * @brief Classify the block starting at {block_}
+   */
+  void load() noexcept {
+    if (static_cast<std::size_t>(end_ - block_) >= scanner::block_size) {
+      bits_ = mask_(block_);
+      return;
+    }
+    //-----------------------------------
+    bits_ = 0;
+    for (auto p = block_; p < end_; ++p) {
+      bits_ |= static_cast<uint32_t>(*p == ':' or *p == '\r' or *p == '\n') << (p - block_);
+    }
+  }
+}; //< class Delimiter_scanner
+
+} //< namespace http
+
+#endif //< HTTP_SCANNER_HPP
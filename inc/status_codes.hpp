@@ -18,17 +18,23 @@
 #ifndef HTTP_STATUS_CODES_HPP
 #define HTTP_STATUS_CODES_HPP
 
-#include <unordered_map>
+#include <array>
+#include <cstdint>
+#include <string_view>
 
 #include "status_code_constants.hpp"
 
 namespace http {
 //------------------------------------------------
-using Code              = int;
-using Description       = const char*;
-using Status_code_table = std::unordered_map<Code, Description>;
+using Code        = int;
+using Description = const char*;
 //------------------------------------------------
-const Status_code_table status_codes {
+struct Status_code {
+  Code        code;
+  Description description;
+};
+//------------------------------------------------
+inline constexpr std::array<Status_code, 58> status_codes {{
   //< 1xx: Informational - Request received, continuing process
   {100, "Continue"},
   {101, "Switching Protocols"},
@@ -96,31 +102,156 @@ const Status_code_table status_codes {
   {508, "Loop Detected"},
   {510, "Not Extended"},
   {511, "Network Authentication Required"}
-}; //< status_codes
+}}; //< status_codes
+
+/**
+ * @enum The class of a status code
+ */
+enum class Status_class : uint8_t {
+  Unknown, Informational, Success, Redirection, Client_error, Server_error
+}; //< enum class Status_class
+
+/**
+ * @brief Compile-time table over the status codes 100-599 holding
+ * the class and registered description of every code, along with
+ * the complete status-line of every registered code pre-rendered
+ * for HTTP/1.0 and HTTP/1.1
+ */
+struct Status_table {
+  static constexpr Code        first_code {100};
+  static constexpr Code        last_code  {599};
+  static constexpr std::size_t line_size  {48}; //< Written with {format::write_short}, so at most 64
+  //-----------------------------------
+  struct Slot {
+    uint8_t      entry;        //< 1-based index into {status_codes}, 0 if unregistered
+    Status_class status_class;
+  };
+  //-----------------------------------
+  struct Line {
+    std::array<char, line_size> bytes;
+    uint8_t                     length;
+  };
+  //-----------------------------------
+  std::array<Slot, last_code - first_code + 1>       slots;
+  std::array<std::array<Line, 2>, status_codes.size()> lines; //< [entry][minor version]
+};
+
+constexpr Status_class classify(const Code code) noexcept {
+  if (code >= Continue and code <= Processing) return Status_class::Informational;
+  if (code >= OK and code <= IM_Used) return Status_class::Success;
+  if (code >= Multiple_Choices and code <= Permanent_Redirect) return Status_class::Redirection;
+  if (code >= Bad_Request and code <= Request_Header_Fields_Too_Large) return Status_class::Client_error;
+  if (code >= Internal_Server_Error and code <= Network_Authentication_Required) return Status_class::Server_error;
+  return Status_class::Unknown;
+}
+
+constexpr Status_table make_status_table() noexcept {
+  Status_table table {};
+  //-----------------------------------
+  for (Code code = Status_table::first_code; code <= Status_table::last_code; ++code) {
+    table.slots[code - Status_table::first_code] = {0, classify(code)};
+  }
+  //-----------------------------------
+  for (std::size_t i = 0; i < status_codes.size(); ++i) {
+    const Code code = status_codes[i].code;
+    table.slots[code - Status_table::first_code].entry = static_cast<uint8_t>(i + 1);
+    //-----------------------------------
+    for (unsigned minor = 0; minor < 2; ++minor) {
+      auto& line = table.lines[i][minor];
+      std::size_t n {0};
+      //-----------------------------------
+      for (const char c : std::string_view{"HTTP/1."}) line.bytes[n++] = c;
+      line.bytes[n++] = static_cast<char>('0' + minor);
+      line.bytes[n++] = ' ';
+      line.bytes[n++] = static_cast<char>('0' + (code / 100));
+      line.bytes[n++] = static_cast<char>('0' + (code / 10) % 10);
+      line.bytes[n++] = static_cast<char>('0' + (code % 10));
+      line.bytes[n++] = ' ';
+      for (const char c : std::string_view{status_codes[i].description}) line.bytes[n++] = c;
+      line.bytes[n++] = '\r';
+      line.bytes[n++] = '\n';
+      //-----------------------------------
+      line.length = static_cast<uint8_t>(n);
+    }
+  }
+  //-----------------------------------
+  return table;
+}
+
+inline constexpr Status_table status_table {make_status_table()};
+
+/**
+ * @brief Get the slot of a status code within {status_table}
+ *
+ * @return The slot, or nullptr if the code is out of range
+ */
+constexpr const Status_table::Slot* status_slot(const Code code) noexcept {
+  return (code < Status_table::first_code or code > Status_table::last_code)
+         ? nullptr : &status_table.slots[code - Status_table::first_code];
+}
+
+/**
+ * @brief Get the class of a status code
+ *
+ * @param code:
+ * The status code
+ *
+ * @return The class of the status code
+ */
+constexpr Status_class status_class(const Code code) noexcept {
+  auto slot = status_slot(code);
+  return (slot == nullptr) ? Status_class::Unknown : slot->status_class;
+}
+
+/**
+ * @brief Get the pre-rendered status-line of a registered status
+ * code, e.g. "HTTP/1.1 200 OK\r\n"
+ *
+ * @param code:
+ * The status code
+ *
+ * @param major:
+ * The major version number
+ *
+ * @param minor:
+ * The minor version number
+ *
+ * @return The status-line, or an empty view if the code is
+ * unregistered or the version is other than HTTP/1.0 or HTTP/1.1
+ */
+constexpr std::string_view status_line_bytes(const Code code, const unsigned major,
+                                             const unsigned minor) noexcept {
+  auto slot = status_slot(code);
+  if (slot == nullptr or slot->entry == 0 or major not_eq 1 or minor > 1) return {};
+  //-----------------------------------
+  const auto& line = status_table.lines[slot->entry - 1][minor];
+  return {line.bytes.data(), line.length};
+}
 
-inline Description code_description(const Code code) noexcept {
-  auto iter = status_codes.find(code);
-  return (iter not_eq status_codes.end()) ? iter->second : "Internal Server Error";
+constexpr Description code_description(const Code code) noexcept {
+  auto slot = status_slot(code);
+  return (slot == nullptr or slot->entry == 0)
+         ? "Internal Server Error" : status_codes[slot->entry - 1].description;
 }
 
-inline bool is_informational(const status_t status_code) noexcept {
-  return (status_code >= Continue) && (status_code <= Processing);
+constexpr bool is_informational(const status_t status_code) noexcept {
+  return status_class(status_code) == Status_class::Informational;
 }
 
-inline bool is_success(const status_t status_code) noexcept {
-  return (status_code >= OK) && (status_code <= IM_Used);
+constexpr bool is_success(const status_t status_code) noexcept {
+  return status_class(status_code) == Status_class::Success;
 }
 
-inline bool is_redirection(const status_t status_code) noexcept {
-  return (status_code >= Multiple_Choices) && (status_code <= Permanent_Redirect);
+constexpr bool is_redirection(const status_t status_code) noexcept {
+  return status_class(status_code) == Status_class::Redirection;
 }
 
-inline bool is_client_error(const status_t status_code) noexcept {
-  return (status_code >= Bad_Request) && (status_code <= Request_Header_Fields_Too_Large);
+constexpr bool is_client_error(const status_t status_code) noexcept {
+  return status_class(status_code) == Status_class::Client_error;
 }
 
-inline bool is_server_error(const status_t status_code) noexcept {
-  return (status_code >= Internal_Server_Error) && (status_code <= Network_Authentication_Required);
+constexpr bool is_server_error(const status_t status_code) noexcept {
+  return status_class(status_code) == Status_class::Server_error;
 }
 
 } //< namespace http
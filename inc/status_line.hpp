@@ -18,7 +18,9 @@
 #ifndef HTTP_STATUS_LINE_HPP
 #define HTTP_STATUS_LINE_HPP
 
-#include <regex>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
 
 #include "version.hpp"
 #include "status_codes.hpp"
@@ -117,6 +119,40 @@ public:
    */
   void set_code(const Code code) noexcept;
 
+  /**
+   * @brief Get the complete status-line including the trailing
+   * CRLF from the compile-time table of status-lines
+   *
+   * @return The status-line, or an empty view if the status code
+   * is unregistered or the version is other than HTTP/1.0 or HTTP/1.1
+   */
+  std::string_view prerendered() const noexcept;
+
+  /**
+   * @brief Get the number of bytes written by {serialize_into}
+   *
+   * @return The serialized size including the trailing CRLF
+   */
+  std::size_t serialized_size() const noexcept;
+
+  /**
+   * @brief Write the status-line including the trailing CRLF
+   *
+   * @param out:
+   * Where to write, with room for {serialized_size()} bytes
+   *
+   * @return Pointer past the last byte written
+   */
+  char* serialize_into(char* out) const noexcept;
+
+  /**
+   * @brief Append the status-line to a string
+   *
+   * @param out:
+   * The string to append to
+   */
+  void append_to(std::string& out) const;
+
   /**
    * @brief Get a string representation of
    * this class
@@ -141,62 +177,155 @@ private:
 /**
  * @brief This class is used to represent an error that occurred
  * from within the operations of class Status_line
+ *
+ * Errors raised while parsing carry the byte offset at which the
+ * input stopped matching the {Status-Line} grammar
  */
 class Status_line_error : public std::runtime_error {
+public:
   using runtime_error::runtime_error;
-};
 
-/**--v----------- Implementation Details -----------v--**/
+  /**
+   * @brief Constructor
+   *
+   * @param what:
+   * A description of the error
+   *
+   * @param offset:
+   * The byte offset into the input where the error was detected
+   */
+  explicit Status_line_error(const std::string& what, const std::size_t offset)
+    : runtime_error{what + " (at byte " + std::to_string(offset) + ')'}
+    , offset_{offset}
+  {}
 
-inline constexpr Status_line::Status_line(const Version version, const Code code) noexcept
-  : version_{version}
-  , code_{code}
-{}
+  /**
+   * @brief Get the byte offset into the input where the error
+   * was detected
+   *
+   * @return The byte offset of the error
+   */
+  std::size_t offset() const noexcept
+  { return offset_; }
+private:
+  std::size_t offset_ {0};
+};
 
-template <typename Response, typename>
-inline Status_line::Status_line(Response&& response) {
-  if (response.empty() or response.size() < 16 /*<-(16) minimum response length */) {
-    throw Status_line_error {"Invalid response"};
-  }
+/**
+ * @brief The components of a {Status-Line} as located in
+ * the input by {parse_status_line}
+ *
+ * The reason phrase points into the parsed bytes
+ */
+struct Status_line_parts {
+  Version          version;
+  Code             code {0};
+  std::string_view reason;
+};
 
-  bool is_canonical_line_ending {false};
+/**
+ * @brief Parse a {Status-Line} in a single pass over the input
+ *
+ * Accepts: "HTTP/" 1*DIGIT "." 1*DIGIT SP 3DIGIT [ SP reason-phrase ]
+ * terminated by either CRLF or LF, where the reason-phrase is any
+ * sequence of HTAB, SP, VCHAR or obs-text (RFC 7230 §3.1.2)
+ *
+ * @param begin:
+ * The start of the input
+ *
+ * @param end:
+ * The end of the input
+ *
+ * @param parts:
+ * Receives the components of the {Status-Line}
+ *
+ * @return Pointer to the first byte after the line-ending
+ *
+ * @note Throws {Status_line_error} carrying the byte offset of the
+ * first byte that does not match the grammar
+ */
+inline const char* parse_status_line(const char* const begin, const char* const end,
+                                     Status_line_parts& parts)
+{
+  const char* cursor = begin;
+
+  auto fail = [begin, &cursor](const char* reason) {
+    throw Status_line_error {reason, static_cast<std::size_t>(cursor - begin)};
+  };
 
-  // Extract {Status-Line} from response
-  std::string status_line;
-  std::size_t index;
+  auto read_number = [&]() {
+    unsigned value {0};
+    const char* const first = cursor;
+    while (cursor < end and *cursor >= '0' and *cursor <= '9') {
+      if (cursor - first == 9) fail("Version number too large");
+      value = (value * 10) + static_cast<unsigned>(*cursor++ - '0');
+    }
+    if (cursor == first) fail("Invalid version");
+    return value;
+  };
 
-  if ((index = response.find("\r\n")) not_eq std::string::npos) {
-    status_line = response.substr(0, index);
-    is_canonical_line_ending = true;
-  } else if ((index = response.find('\n')) not_eq std::string::npos) {
-    status_line = response.substr(0, index);
-  } else {
-    throw Status_line_error {"Invalid line-ending"};
+  // HTTP-version
+  if ((end - cursor) < 5 or std::memcmp(cursor, "HTTP/", 5) not_eq 0) fail("Invalid version");
+  cursor += 5;
+
+  const unsigned major = read_number();
+  if (cursor == end or *cursor not_eq '.') fail("Invalid version");
+  ++cursor;
+  const unsigned minor = read_number();
+  parts.version = Version{major, minor};
+
+  if (cursor == end or *cursor not_eq ' ') fail("Expected SP after version");
+  ++cursor;
+
+  // Status-code
+  if ((end - cursor) < 3) fail("Invalid status code");
+  parts.code = 0;
+  for (int i = 0; i < 3; ++i, ++cursor) {
+    if (*cursor < '0' or *cursor > '9') fail("Invalid status code");
+    parts.code = (parts.code * 10) + (*cursor - '0');
+  }
+  if (cursor < end and *cursor not_eq ' ' and *cursor not_eq '\r' and *cursor not_eq '\n') {
+    fail("Invalid status code");
   }
 
-  const static std::regex status_line_pattern
+  // Reason-phrase
+  if (cursor < end and *cursor == ' ') ++cursor;
+  const char* const reason = cursor;
+  while (cursor < end
+         and (*cursor == '\t' or static_cast<unsigned char>(*cursor) >= ' ')
+         and *cursor not_eq '\x7f')
   {
-    "HTTP/(\\d+)\\.(\\d+) " //< Protocol Version {Major.Minor}
-    "(\\d{3}) "             //< Response Code
-    "[a-z A-Z]+"            //< Response Code Description
-  };
+    ++cursor;
+  }
+  parts.reason = {reason, static_cast<std::size_t>(cursor - reason)};
 
-  std::smatch m;
+  // Line-ending
+  if (cursor < end and *cursor == '\r') ++cursor;
+  if (cursor == end) throw Status_line_error {"Invalid line-ending"};
+  if (*cursor not_eq '\n') fail("Invalid character in reason phrase");
 
-  if (not std::regex_match(status_line, m, status_line_pattern)) {
-    throw Status_line_error {"Invalid response line: " + status_line};
-  }
+  return cursor + 1;
+}
 
-  version_ = Version(std::stoi(m[1]), std::stoi(m[2]));
+/**--v----------- Implementation Details -----------v--**/
 
-  code_ = std::stoi(m[3]);
+inline constexpr Status_line::Status_line(const Version version, const Code code) noexcept
+  : version_{version}
+  , code_{code}
+{}
+
+template <typename Response, typename>
+inline Status_line::Status_line(Response&& response) {
+  Status_line_parts parts;
+
+  auto data = response.data();
+  auto next = parse_status_line(data, data + response.size(), parts);
+
+  version_ = parts.version;
+  code_    = parts.code;
 
   // Trim the response for further processing
-  if (is_canonical_line_ending) {
-    response = response.substr(index + 2);
-  } else {
-    response = response.substr(index + 1);
-  }
+  response.erase(0, next - data);
 }
 
 inline constexpr Version Status_line::get_version() const noexcept {
@@ -215,14 +344,43 @@ inline void Status_line::set_code(const Code code) noexcept {
   code_ = code;
 }
 
+inline std::string_view Status_line::prerendered() const noexcept {
+  return status_line_bytes(code_, version_.get_major(), version_.get_minor());
+}
+
+inline std::size_t Status_line::serialized_size() const noexcept {
+  const auto line = prerendered();
+  if (not line.empty()) return line.size();
+  //---------------------------
+  return version_.serialized_size() + 1
+       + format::decimal_size(static_cast<unsigned>(code_)) + 1
+       + std::strlen(code_description(code_)) + 2;
+}
+
+inline char* Status_line::serialize_into(char* out) const noexcept {
+  const auto line = prerendered();
+  if (not line.empty()) return format::write_short(out, line);
+  //---------------------------
+  out    = version_.serialize_into(out);
+  *out++ = ' ';
+  out    = format::write_decimal(out, static_cast<unsigned>(code_));
+  *out++ = ' ';
+  out    = format::write(out, code_description(code_));
+  return format::write(out, "\r\n");
+}
+
+inline void Status_line::append_to(std::string& out) const {
+  const auto size = out.size();
+  out.resize(size + serialized_size());
+  serialize_into(&out[size]);
+}
+
 inline std::string Status_line::to_string() const {
-  std::ostringstream stat_line;
+  std::string stat_line;
   //---------------------------
-  stat_line << version_                << " "
-            << code_                   << " "
-            << code_description(code_) << "\r\n";
+  append_to(stat_line);
   //---------------------------
-  return stat_line.str();
+  return stat_line;
 }
 
 inline Status_line::operator std::string () const {
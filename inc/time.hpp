@@ -15,14 +15,184 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifndef HTTP_TIME_HPP
+#define HTTP_TIME_HPP
+
+#include <array>
 #include <ctime>
+#include <limits>
 #include <string>
-#include <sstream>
-#include <iomanip>
+#include <cstdint>
+#include <string_view>
+
+#include "ascii.hpp"
 
 namespace http {
 namespace time {
 
+/**
+ * @brief The size of a timestamp in IMF-fixdate format,
+ * e.g. "Sun, 06 Nov 1994 08:49:37 GMT"
+ */
+constexpr std::size_t imf_fixdate_size {29};
+
+/**
+ * @brief A date in the proleptic Gregorian calendar
+ */
+struct Civil_date {
+  int64_t  year;
+  unsigned month; //< [1, 12]
+  unsigned day;   //< [1, 31]
+};
+
+/**
+ * @brief Get the calendar date of a number of days since
+ * 1970-01-01, without going through the C library
+ *
+ * @param days:
+ * Days since 1970-01-01
+ *
+ * @return The calendar date
+ */
+constexpr Civil_date civil_from_days(int64_t days) noexcept {
+  days += 719468;
+  //-----------------------------------
+  const int64_t  era = ((days >= 0) ? days : days - 146096) / 146097;
+  const unsigned doe = static_cast<unsigned>(days - era * 146097);
+  const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const unsigned mp  = (5 * doy + 2) / 153;
+  const unsigned day = doy - (153 * mp + 2) / 5 + 1;
+  const unsigned mon = (mp < 10) ? mp + 3 : mp - 9;
+  //-----------------------------------
+  return {static_cast<int64_t>(yoe) + era * 400 + (mon <= 2), mon, day};
+}
+
+/**
+ * @brief Write a timestamp in IMF-fixdate format (RFC 7231 §7.1.1.1)
+ *
+ * Day and month names are written from fixed tables, so the
+ * output does not depend on the locale
+ *
+ * @param out:
+ * Where to write, with room for {imf_fixdate_size} bytes
+ *
+ * @param time:
+ * Seconds since the epoch
+ *
+ * @return Pointer past the last byte written, or {nullptr} if the
+ * year of {time} does not fit in four digits
+ */
+inline char* write_imf_fixdate(char* out, const std::time_t time) noexcept {
+  static constexpr char days_of_week[] {"ThuFriSatSunMonTueWed"};
+  static constexpr char months[]       {"JanFebMarAprMayJunJulAugSepOctNovDec"};
+  //-----------------------------------
+  const int64_t seconds = time;
+  int64_t days          = seconds / 86400;
+  int64_t second_of_day = seconds % 86400;
+  if (second_of_day < 0) {
+    second_of_day += 86400;
+    --days;
+  }
+  //-----------------------------------
+  const auto date = civil_from_days(days);
+  if (date.year < 0 or date.year > 9999) return nullptr;
+  //-----------------------------------
+  auto two_digits = [](char* p, const unsigned n) {
+    p[0] = static_cast<char>('0' + n / 10);
+    p[1] = static_cast<char>('0' + n % 10);
+  };
+  //-----------------------------------
+  const auto weekday = static_cast<unsigned>(((days % 7) + 7) % 7);
+  const auto year    = static_cast<unsigned>(date.year);
+  const auto hms     = static_cast<unsigned>(second_of_day);
+  //-----------------------------------
+  out[0] = days_of_week[weekday * 3];
+  out[1] = days_of_week[weekday * 3 + 1];
+  out[2] = days_of_week[weekday * 3 + 2];
+  out[3] = ',';
+  out[4] = ' ';
+  two_digits(out + 5, date.day);
+  out[7] = ' ';
+  out[8]  = months[(date.month - 1) * 3];
+  out[9]  = months[(date.month - 1) * 3 + 1];
+  out[10] = months[(date.month - 1) * 3 + 2];
+  out[11] = ' ';
+  two_digits(out + 12, year / 100);
+  two_digits(out + 14, year % 100);
+  out[16] = ' ';
+  two_digits(out + 17, hms / 3600);
+  out[19] = ':';
+  two_digits(out + 20, (hms / 60) % 60);
+  out[22] = ':';
+  two_digits(out + 23, hms % 60);
+  out[25] = ' ';
+  out[26] = 'G';
+  out[27] = 'M';
+  out[28] = 'T';
+  //-----------------------------------
+  return out + imf_fixdate_size;
+}
+
+/**
+ * @brief This class caches the IMF-fixdate rendering of the
+ * current second, so a server emitting a {Date} header on every
+ * response formats it at most once per second
+ *
+ * A cache is meant to be owned by a single thread or event loop
+ */
+class Date_cache {
+public:
+  /**
+   * @brief Get the IMF-fixdate rendering of a time, formatting
+   * it only if the second differs from the previous call
+   *
+   * @param time:
+   * Seconds since the epoch, e.g. the time of the current
+   * event loop tick
+   *
+   * @return A view of the cached timestamp which is valid until the
+   * next call with a different second, or an empty view if {time}
+   * cannot be represented
+   */
+  std::string_view get(const std::time_t time) noexcept;
+private:
+  //-----------------------------------
+  // Class data members
+  std::time_t                          second_ {std::numeric_limits<std::time_t>::min()};
+  std::array<char, imf_fixdate_size>   bytes_;
+  std::size_t                          size_ {0};
+  //-----------------------------------
+}; //< class Date_cache
+
+/**--v----------- Implementation Details -----------v--**/
+
+inline std::string_view Date_cache::get(const std::time_t time) noexcept {
+  if (time not_eq second_) {
+    const auto end = write_imf_fixdate(bytes_.data(), time);
+    size_   = (end == nullptr) ? 0 : imf_fixdate_size;
+    second_ = time;
+  }
+  return {bytes_.data(), size_};
+}
+
+/**--^----------- Implementation Details -----------^--**/
+
+/**
+ * @brief Get the IMF-fixdate rendering of a time from the cache
+ * of the calling thread
+ *
+ * @param time:
+ * Seconds since the epoch, defaults to the current time
+ *
+ * @return A view of the timestamp which is valid until the calling
+ * thread asks for a different second
+ */
+inline std::string_view date(const std::time_t time = std::time(nullptr)) noexcept {
+  thread_local Date_cache cache;
+  return cache.get(time);
+}
+
 /**
  * @brief Get the time in {Internet Standard Format} from
  * a {time_t} object 
@@ -36,50 +206,182 @@ namespace time {
  * @note Returns an empty string if an error occurred
  */
 inline std::string from_time_t(const std::time_t time) {
-  auto tm = std::gmtime(&time);
+  char buffer[imf_fixdate_size];
+  const auto end = write_imf_fixdate(buffer, time);
+  return (end == nullptr) ? std::string{} : std::string(buffer, imf_fixdate_size);
+}
+
+/**
+ * @brief Get the number of days since 1970-01-01 of a date in
+ * the proleptic Gregorian calendar, without going through the
+ * C library
+ *
+ * @param year:
+ * The year
+ *
+ * @param month:
+ * The month [1, 12]
+ *
+ * @param day:
+ * The day of the month [1, 31]
+ *
+ * @return Days since 1970-01-01
+ */
+constexpr int64_t days_from_civil(int64_t year, const unsigned month, const unsigned day) noexcept {
+  year -= (month <= 2);
+  //-----------------------------------
+  const int64_t  era = ((year >= 0) ? year : year - 399) / 400;
+  const unsigned yoe = static_cast<unsigned>(year - era * 400);
+  const unsigned doy = (153 * ((month > 2) ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  //-----------------------------------
+  return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
 
-  if (tm) {
-    std::ostringstream output;
-    output << std::put_time(tm, "%a, %d %b %Y %H:%M:%S %Z");
-    return output.str();
+/**
+ * @brief Get the month [1, 12] of a three letter month name
+ * (case-insensitive), or 0 if it is not a month name
+ */
+constexpr unsigned month_from_name(const std::string_view name) noexcept {
+  if (name.size() not_eq 3) return 0;
+  //-----------------------------------
+  const uint32_t key = (static_cast<uint32_t>(to_lower(name[0])) << 16)
+                     | (static_cast<uint32_t>(to_lower(name[1])) << 8)
+                     |  static_cast<uint32_t>(to_lower(name[2]));
+  //-----------------------------------
+  switch (key) {
+    case 0x6a616e: return 1;  //< jan
+    case 0x666562: return 2;  //< feb
+    case 0x6d6172: return 3;  //< mar
+    case 0x617072: return 4;  //< apr
+    case 0x6d6179: return 5;  //< may
+    case 0x6a756e: return 6;  //< jun
+    case 0x6a756c: return 7;  //< jul
+    case 0x617567: return 8;  //< aug
+    case 0x736570: return 9;  //< sep
+    case 0x6f6374: return 10; //< oct
+    case 0x6e6f76: return 11; //< nov
+    case 0x646563: return 12; //< dec
+    default:       return 0;
   }
+}
 
-  return std::string {};
+/**
+ * @brief Parse a timestamp in any of the HTTP-date formats
+ * (RFC 7231 §7.1.1.1):
+ *
+ * IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT"
+ * RFC 850:     "Sunday, 06-Nov-94 08:49:37 GMT"
+ * asctime:     "Sun Nov  6 08:49:37 1994"
+ *
+ * Timestamps are always interpreted as UTC. Two-digit RFC 850
+ * years 69-99 are taken as 19xx and 00-68 as 20xx. Day names
+ * are not checked against the date
+ *
+ * @param text:
+ * The timestamp, e.g. the value of an {If-Modified-Since} field
+ *
+ * @param time:
+ * Receives the seconds since the epoch on success
+ *
+ * @return true if {text} is a valid HTTP-date, false otherwise
+ */
+inline bool parse_http_date(const std::string_view text, std::time_t& time) noexcept {
+  const char* cursor    = text.data();
+  const char* const end = cursor + text.size();
+  //-----------------------------------
+  auto is_digit = [](const char c) { return c >= '0' and c <= '9'; };
+  //-----------------------------------
+  auto literal = [&cursor, end](const char c) {
+    if (cursor == end or *cursor not_eq c) return false;
+    ++cursor;
+    return true;
+  };
+  //-----------------------------------
+  auto letters = [&cursor, end]() {
+    const char* const start = cursor;
+    while (cursor < end and ((*cursor | 0x20) >= 'a' and (*cursor | 0x20) <= 'z')) ++cursor;
+    return std::string_view{start, static_cast<std::size_t>(cursor - start)};
+  };
+  //-----------------------------------
+  auto digits = [&cursor, end, &is_digit](const std::size_t count, unsigned& value) {
+    if (static_cast<std::size_t>(end - cursor) < count) return false;
+    unsigned result {0};
+    for (std::size_t i = 0; i < count; ++i) {
+      if (not is_digit(cursor[i])) return false;
+      result = result * 10 + static_cast<unsigned>(cursor[i] - '0');
+    }
+    cursor += count;
+    value   = result;
+    return true;
+  };
+  //-----------------------------------
+  auto clock = [&](unsigned& hour, unsigned& minute, unsigned& second) {
+    return digits(2, hour) and literal(':') and digits(2, minute) and literal(':')
+       and digits(2, second);
+  };
+  //-----------------------------------
+  unsigned year {0}, month {0}, day {0}, hour {0}, minute {0}, second {0};
+  //-----------------------------------
+  const auto day_name = letters();
+  if (day_name.size() < 3) return false;
+  //-----------------------------------
+  if (literal(',')) {
+    if (not literal(' ')) return false;
+    //-----------------------------------
+    if (day_name.size() == 3) {
+      // IMF-fixdate
+      if (not (digits(2, day) and literal(' '))) return false;
+      month = month_from_name(letters());
+      if (not (literal(' ') and digits(4, year) and literal(' '))) return false;
+    } else {
+      // RFC 850
+      if (not (digits(2, day) and literal('-'))) return false;
+      month = month_from_name(letters());
+      if (not (literal('-') and digits(2, year) and literal(' '))) return false;
+      year += (year < 69) ? 2000 : 1900;
+    }
+    //-----------------------------------
+    if (not (clock(hour, minute, second) and literal(' ') and literal('G')
+             and literal('M') and literal('T'))) return false;
+  } else {
+    // asctime
+    if (day_name.size() not_eq 3 or not literal(' ')) return false;
+    month = month_from_name(letters());
+    if (not literal(' ')) return false;
+    //-----------------------------------
+    if (literal(' ')) {
+      if (not digits(1, day)) return false;
+    } else if (not digits(2, day) and not digits(1, day)) {
+      return false;
+    }
+    //-----------------------------------
+    if (not (literal(' ') and clock(hour, minute, second) and literal(' ')
+             and digits(4, year))) return false;
+  }
+  //-----------------------------------
+  if (cursor not_eq end or month == 0 or day == 0 or day > 31
+      or hour > 23 or minute > 59 or second > 60) return false;
+  //-----------------------------------
+  time = static_cast<std::time_t>(days_from_civil(year, month, day) * 86400
+                                  + hour * 3600 + minute * 60 + second);
+  return true;
 }
 
 /**
- * @brief Get a {time_t} object from a {std::string} representing
- * timestamps specified in RFC 2616 §3.3
+ * @brief Get a {time_t} object from a timestamp in any of the
+ * HTTP-date formats, see {parse_http_date}
  *
  * @param time:
- * The {std::string} representing the timestamp
+ * The timestamp
  *
  * @return A {time_t} object from {time}
  *
  * @note Returns a default initialized {time_t} object if an error occurred
  */
-inline std::time_t to_time_t(const std::string& time) {
-  std::tm tm {};
-
-  if (time.empty()) goto error;
-
-  // Format: Sun, 06 Nov 1994 08:49:37 GMT
-  if (strptime(time.c_str(), "%a, %d %b %Y %H:%M:%S %Z", &tm) not_eq nullptr) {
-    return std::mktime(&tm);
-  }
-
-  // Format: Sunday, 06-Nov-94 08:49:37 GMT
-  if (strptime(time.c_str(), "%a, %d-%b-%y %H:%M:%S %Z", &tm) not_eq nullptr) {
-    return std::mktime(&tm);
-  }
-
-  // Format: Sun Nov 6 08:49:37 1994
-  if(strptime(time.c_str(), "%a %b %d %H:%M:%S %Y", &tm) not_eq nullptr) {
-    return std::mktime(&tm);
-  }
-
-  error:
-  	return std::time_t {};
+inline std::time_t to_time_t(const std::string_view time) noexcept {
+  std::time_t result {};
+  return parse_http_date(time, result) ? result : std::time_t{};
 }
 
 /**
@@ -90,9 +392,10 @@ inline std::time_t to_time_t(const std::string& time) {
  * @note Returns an empty string if an error occurred
  */
 inline std::string now() {
-  auto time_object = std::time(nullptr);
-  return from_time_t(time_object);
+  return std::string{date()};
 }
 
 } //< namespace time
 } //< namespace http
+
+#endif //< HTTP_TIME_HPP
@@ -19,7 +19,9 @@
 #define HTTP_VERSION_HPP
 
 #include <string>
-#include <sstream>
+#include <ostream>
+
+#include "format.hpp"
 
 namespace http {
 
@@ -95,6 +97,31 @@ public:
    */
   void set_minor(const unsigned minor) noexcept;
 
+  /**
+   * @brief Get the number of bytes written by {serialize_into}
+   *
+   * @return The serialized size, e.g. 8 for "HTTP/1.1"
+   */
+  constexpr std::size_t serialized_size() const noexcept;
+
+  /**
+   * @brief Write the version, e.g. "HTTP/1.1"
+   *
+   * @param out:
+   * Where to write, with room for {serialized_size()} bytes
+   *
+   * @return Pointer past the last byte written
+   */
+  char* serialize_into(char* out) const noexcept;
+
+  /**
+   * @brief Append the version to a string
+   *
+   * @param out:
+   * The string to append to
+   */
+  void append_to(std::string& out) const;
+
   /**
    * @brief Get a string representation of this
    * class
@@ -139,13 +166,29 @@ inline void Version::set_minor(const unsigned minor) noexcept {
   minor_ = minor;
 }
 
+inline constexpr std::size_t Version::serialized_size() const noexcept {
+  return 6 + format::decimal_size(major_) + format::decimal_size(minor_);
+}
+
+inline char* Version::serialize_into(char* out) const noexcept {
+  out = format::write(out, "HTTP/");
+  out = format::write_decimal(out, major_);
+  *out++ = '.';
+  return format::write_decimal(out, minor_);
+}
+
+inline void Version::append_to(std::string& out) const {
+  const auto size = out.size();
+  out.resize(size + serialized_size());
+  serialize_into(&out[size]);
+}
+
 inline std::string Version::to_string() const {
-  std::ostringstream ver_data;
+  std::string ver_data;
   //----------------------------
-  ver_data << "HTTP/" << major_
-           << "."     << minor_;
+  append_to(ver_data);
   //-----------------------------
-  return ver_data.str();
+  return ver_data;
 }
 
 inline Version::operator std::string () const {
@@ -0,0 +1,67 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_BENCH_ALLOCATIONS_HPP
+#define HTTP_BENCH_ALLOCATIONS_HPP
+
+// Replaces the global allocation functions to count heap allocations,
+// so it must be included by exactly one translation unit per benchmark
+
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+
+namespace bench {
+
+/**
+ * @brief Number of heap allocations since it was last reset
+ */
+inline std::size_t allocations {0};
+
+/**
+ * @brief Number of bytes requested from the heap since it was
+ * last reset
+ */
+inline std::size_t allocated_bytes {0};
+
+} //< namespace bench
+
+void* operator new(std::size_t size) {
+  ++bench::allocations;
+  bench::allocated_bytes += size;
+  if (auto p = std::malloc(size)) return p;
+  throw std::bad_alloc{};
+}
+
+// std::pmr::new_delete_resource() allocates through the aligned forms
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  ++bench::allocations;
+  bench::allocated_bytes += size;
+  const auto align = static_cast<std::size_t>(alignment);
+  if (auto p = std::aligned_alloc(align, (size + align - 1) & ~(align - 1))) return p;
+  throw std::bad_alloc{};
+}
+
+// The sized forms forward to the unsized ones of the same alignment,
+// which are kept out of line: inlined, g++ would see free() on memory
+// from operator new and warn of a mismatch (-Wmismatched-new-delete)
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { ::operator delete(p); }
+void operator delete(void* p, std::size_t, std::align_val_t alignment) noexcept { ::operator delete(p, alignment); }
+
+#endif //< HTTP_BENCH_ALLOCATIONS_HPP
@@ -0,0 +1,76 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Request and response allocated from the global heap against a
+// per-request arena that is released in one shot once the response
+// has been serialized
+
+#include <memory_resource>
+#include <request.hpp>
+#include <response.hpp>
+
+#include "bench.hpp"
+#include "allocations.hpp"
+
+using namespace http;
+
+int main() {
+  const std::string ingress {
+    "POST /api/v1/reports HTTP/1.1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:49.0) Gecko/20100101 Firefox/49.0\r\n"
+    "Accept: application/json\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://www.includeos.org/dashboard\r\n"
+    "Content-Type: application/json\r\n"
+    "Cookie: session=f3a9c0e1d2b4; theme=dark; consent=analytics,functional\r\n"
+    "Host: www.includeos.org\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+    "{\"title\": \"Quarterly report\", \"format\": \"pdf\", \"sections\": [1, 2, 3]}"
+  };
+
+  const std::string body (2048, 'x');
+  std::string output;
+  constexpr std::size_t requests {100000};
+
+  auto serve = [&](std::pmr::memory_resource* resource) {
+    Request  request {ingress, 25, resource};
+    Response response {OK, Version{}, resource};
+    response.add_header(header_fields::Response::Server, "IncludeOS/0.7.0")
+            .add_header(header_fields::Entity::Content_Type, "application/json")
+            .add_header(header_fields::Response::Location, "/api/v1/reports/quarterly-report-2016")
+            .add_body(body);
+    output.clear();
+    response.append_to(output);
+    bench::keep(request.method());
+  };
+
+  bench::allocations = 0;
+  bench::latency("global heap", requests, [&] { serve(std::pmr::get_default_resource()); });
+  std::printf("  allocations per request: %.1f\n", bench::allocations / (requests * 1.1 + 1));
+
+  alignas(std::max_align_t) static char buffer[16384];
+  std::pmr::monotonic_buffer_resource arena {buffer, sizeof buffer};
+
+  bench::allocations = 0;
+  bench::latency("per-request arena", requests, [&] {
+    serve(&arena);
+    arena.release();
+  });
+  std::printf("  allocations per request: %.1f\n", bench::allocations / (requests * 1.1 + 1));
+}
@@ -0,0 +1,131 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef HTTP_BENCH_HPP
+#define HTTP_BENCH_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+namespace bench {
+
+/**
+ * @brief Prevent the compiler from optimizing away a computed value
+ */
+template <typename T>
+inline void keep(T&& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Run an operation a number of times and report the
+ * average time spent per operation
+ *
+ * @param name:
+ * Label printed alongside the result
+ *
+ * @param iterations:
+ * Number of times to run the operation
+ *
+ * @param operation:
+ * The operation to measure
+ *
+ * @return Nanoseconds per operation
+ */
+template <typename Operation>
+inline double run(const char* name, const std::size_t iterations, Operation&& operation) {
+  using Clock = std::chrono::steady_clock;
+  //-----------------------------------
+  for (std::size_t i = 0; i < (iterations / 10) + 1; ++i) operation();
+  //-----------------------------------
+  const auto start = Clock::now();
+  for (std::size_t i = 0; i < iterations; ++i) operation();
+  const auto stop  = Clock::now();
+  //-----------------------------------
+  const double ns = std::chrono::duration<double, std::nano>(stop - start).count() / iterations;
+  std::printf("%-48s %12.1f ns/op\n", name, ns);
+  return ns;
+}
+
+/**
+ * @brief Time a single invocation of an operation
+ *
+ * @param name:
+ * Label printed alongside the result
+ *
+ * @param operation:
+ * The operation to measure
+ *
+ * @return Nanoseconds spent
+ */
+template <typename Operation>
+inline double once(const char* name, Operation&& operation) {
+  using Clock = std::chrono::steady_clock;
+  //-----------------------------------
+  const auto start = Clock::now();
+  operation();
+  const auto stop  = Clock::now();
+  //-----------------------------------
+  const double ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  std::printf("%-48s %12.1f ns\n", name, ns);
+  return ns;
+}
+
+/**
+ * @brief Time each of a number of runs of an operation and report
+ * the median and 99th percentile
+ *
+ * @param name:
+ * Label printed alongside the result
+ *
+ * @param iterations:
+ * Number of times to run the operation
+ *
+ * @param operation:
+ * The operation to measure
+ *
+ * @return Nanoseconds at the 99th percentile
+ */
+template <typename Operation>
+inline double latency(const char* name, const std::size_t iterations, Operation&& operation) {
+  using Clock = std::chrono::steady_clock;
+  //-----------------------------------
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  //-----------------------------------
+  for (std::size_t i = 0; i < (iterations / 10) + 1; ++i) operation();
+  //-----------------------------------
+  for (std::size_t i = 0; i < iterations; ++i) {
+    const auto start = Clock::now();
+    operation();
+    const auto stop  = Clock::now();
+    samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+  }
+  //-----------------------------------
+  std::sort(samples.begin(), samples.end());
+  const double p50 = samples[samples.size() / 2];
+  const double p99 = samples[samples.size() * 99 / 100];
+  std::printf("%-48s %12.1f ns p50 %12.1f ns p99\n", name, p50, p99);
+  return p99;
+}
+
+} //< namespace bench
+
+#endif //< HTTP_BENCH_HPP
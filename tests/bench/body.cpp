@@ -0,0 +1,148 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Body backends: heap held per in-flight response while building and
+// writing a 16 MB response through a writer standing in for a socket,
+// and building a body from many small appends; time to the first
+// byte of a response produced in blocks, buffered or streamed
+
+#include <cstdio>
+#include <chrono>
+#include <response.hpp>
+
+#include "bench.hpp"
+#include "allocations.hpp"
+
+using namespace http;
+
+// Discards the bytes like a socket would once they are sent, and
+// takes file regions whole like {sendfile}
+struct Socket : Writer {
+  std::size_t sent {0};
+  void write(std::string_view bytes) override { sent += bytes.size(); }
+  void write_file(int, off_t, const std::size_t length) override { sent += length; }
+};
+
+// Notes when the first byte goes out
+struct Timed_socket : Socket {
+  std::chrono::steady_clock::time_point first;
+  void write(std::string_view bytes) override {
+    if (sent == 0) first = std::chrono::steady_clock::now();
+    Socket::write(bytes);
+  }
+};
+
+constexpr std::size_t body_size {16 << 20};
+
+template <typename Send>
+void first_byte(const char* name, Send&& send) {
+  bench::allocations = bench::allocated_bytes = 0;
+  Timed_socket socket;
+  //-----------------------------------
+  const auto start = std::chrono::steady_clock::now();
+  bench::once(name, [&] { send(socket); });
+  //-----------------------------------
+  const auto ttfb = std::chrono::duration<double, std::micro>(socket.first - start).count();
+  std::printf("  first byte after %.1f us, sent %zu bytes, allocated %zu bytes\n",
+              ttfb, socket.sent, bench::allocated_bytes);
+}
+
+template <typename Build>
+void measure(const char* name, Build&& build) {
+  bench::allocations = bench::allocated_bytes = 0;
+  Socket socket;
+  //-----------------------------------
+  bench::once(name, [&] {
+    Response response;
+    build(response);
+    response.write_to(socket);
+  });
+  //-----------------------------------
+  std::printf("  sent %zu bytes, allocated %zu bytes in %zu allocations\n",
+              socket.sent, bench::allocated_bytes, bench::allocations);
+}
+
+int main() {
+  const std::string block(Body::generator_block, 'x');
+
+  measure("buffer body", [&](Response& response) {
+    std::string body;
+    for (std::size_t n = 0; n < body_size; n += block.size()) body.append(block);
+    response.add_body(body);
+  });
+
+  measure("rope body", [&](Response& response) {
+    Body body;
+    body.to_rope();
+    for (std::size_t n = 0; n < body_size; n += block.size()) body.append(block);
+    response.set_body(std::move(body));
+  });
+
+  std::FILE* file = std::tmpfile();
+  for (std::size_t n = 0; n < body_size; n += block.size()) std::fwrite(block.data(), 1, block.size(), file);
+  std::fflush(file);
+
+  measure("file region body", [&](Response& response) {
+    Body body;
+    body.assign_file({fileno(file), 0, body_size});
+    response.set_body(std::move(body));
+  });
+
+  measure("generator body", [&](Response& response) {
+    std::size_t remaining = body_size;
+    Body body;
+    body.assign_generator([&block, remaining](char* out, const std::size_t capacity) mutable {
+      const auto n = std::min({remaining, capacity, block.size()});
+      std::copy(block.data(), block.data() + n, out);
+      remaining -= n;
+      return n;
+    }, body_size);
+    response.set_body(std::move(body));
+  });
+
+  std::fclose(file);
+
+  first_byte("buffered 16 MB response", [&](Writer& socket) {
+    Response response;
+    for (std::size_t n = 0; n < body_size; n += block.size()) response.append_body(block);
+    response.write_to(socket);
+  });
+
+  first_byte("streamed 16 MB response", [&](Writer& socket) {
+    Response response;
+    auto stream = response.stream(socket);
+    for (std::size_t n = 0; n < body_size; n += block.size()) stream.write(block);
+    stream.finish();
+  });
+
+  const std::string piece(32, 'x');
+
+  bench::run("500 appends, Content-Length per append", 2000, [&] {
+    Response response;
+    for (int i = 0; i < 500; ++i) {
+      response.append_body(piece);
+      response.set_header(header_fields::Entity::Content_Length, std::to_string(response.body().size()));
+    }
+    bench::keep(response.content_length());
+  });
+
+  bench::run("500 appends, Content-Length when serialized", 2000, [&] {
+    Response response;
+    for (int i = 0; i < 500; ++i) response.append_body(piece);
+    bench::keep(response.serialized_size());
+  });
+}
@@ -0,0 +1,82 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Date header values: the per-second cache and the formatter against
+// the former gmtime + put_time into an ostringstream, and the HTTP-date
+// parser against the former strptime + mktime
+
+#include <sstream>
+#include <iomanip>
+#include <time.hpp>
+
+#include "bench.hpp"
+
+namespace legacy {
+
+// The former time::now()
+inline std::string now() {
+  auto time = std::time(nullptr);
+  auto tm   = std::gmtime(&time);
+  std::ostringstream output;
+  output << std::put_time(tm, "%a, %d %b %Y %H:%M:%S %Z");
+  return output.str();
+}
+
+// The former time::to_time_t
+inline std::time_t to_time_t(const std::string& time) {
+  std::tm tm {};
+  if (strptime(time.c_str(), "%a, %d %b %Y %H:%M:%S %Z", &tm) not_eq nullptr) return std::mktime(&tm);
+  if (strptime(time.c_str(), "%a, %d-%b-%y %H:%M:%S %Z", &tm) not_eq nullptr) return std::mktime(&tm);
+  if (strptime(time.c_str(), "%a %b %d %H:%M:%S %Y", &tm) not_eq nullptr) return std::mktime(&tm);
+  return std::time_t {};
+}
+
+} //< namespace legacy
+
+int main() {
+  const auto old_ns = bench::run("gmtime + put_time", 200000, [] {
+    bench::keep(legacy::now());
+  });
+
+  std::time_t t {784111777};
+  bench::run("write_imf_fixdate (every call)", 1000000, [&t] {
+    char buffer[http::time::imf_fixdate_size];
+    bench::keep(http::time::write_imf_fixdate(buffer, ++t));
+    bench::keep(buffer[0]);
+  });
+
+  const auto new_ns = bench::run("time::date (cached per second)", 1000000, [] {
+    bench::keep(http::time::date().data());
+  });
+
+  std::printf("speedup: %.1fx\n", old_ns / new_ns);
+
+  const std::string imf {"Sun, 06 Nov 1994 08:49:37 GMT"};
+  const std::string asctime {"Sun Nov  6 08:49:37 1994"};
+
+  const auto old_parse_ns = bench::run("strptime + mktime (IMF-fixdate, asctime)", 100000, [&] {
+    bench::keep(legacy::to_time_t(imf));
+    bench::keep(legacy::to_time_t(asctime));
+  });
+
+  const auto new_parse_ns = bench::run("parse_http_date (IMF-fixdate, asctime)", 1000000, [&] {
+    bench::keep(http::time::to_time_t(imf));
+    bench::keep(http::time::to_time_t(asctime));
+  });
+
+  std::printf("speedup: %.1fx\n", old_parse_ns / new_parse_ns);
+}
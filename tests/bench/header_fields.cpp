@@ -0,0 +1,131 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Header section parsing: block scanner against the former per-character loop
+
+#include <header.hpp>
+
+#include "bench.hpp"
+
+using namespace http;
+
+namespace legacy {
+
+// The former Header::add_fields, feeding the same Header::add_field
+inline void add_fields(Header& header, const std::string& data) {
+  auto iterator = data.cbegin();
+  auto sentinel = data.cend();
+  std::string field;
+  std::string value;
+  field.reserve(24);
+  value.reserve(64);
+  Limit limit {0};
+  int character = *iterator;
+  const int stop_char = std::char_traits<std::string::value_type>::eof();
+  while (iterator not_eq sentinel and character not_eq stop_char and limit < header.get_limit()) {
+    field.clear();
+    value.clear();
+    while (iterator not_eq sentinel and isspace(character)) character = *++iterator;
+    while (iterator not_eq sentinel and character not_eq stop_char and character not_eq ':'
+           and not iscntrl(character) and not isspace(character)) {
+      field += character;
+      character = *++iterator;
+    }
+    while (iterator not_eq sentinel and isspace(character)) character = *++iterator;
+    if (character not_eq ':') return;
+    if (iterator not_eq sentinel) character = *++iterator;
+    while (iterator not_eq sentinel and isspace(character)) character = *++iterator;
+parse_value:
+    while (iterator not_eq sentinel and character not_eq stop_char and not iscntrl(character)
+           and character not_eq '\r' and character not_eq '\n') {
+      value += character;
+      character = *++iterator;
+    }
+    int lws_count {0};
+    while (iterator not_eq sentinel and (character == '\r' || character == '\n')) {
+      character = *++iterator;
+      ++lws_count;
+    }
+    if (lws_count == 3) break;
+    while (iterator not_eq sentinel and isspace(character)) {
+      character = *++iterator;
+      if (iterator not_eq sentinel and ((iterator + 1) not_eq sentinel) and isspace(*(iterator + 1)))
+        continue;
+      goto parse_value;
+    }
+    header.add_field(field, value);
+    ++limit;
+  }
+}
+
+} //< namespace legacy
+
+int main() {
+  const std::string fields {
+    "Host: www.includeos.org\r\n"
+    "Connection: keep-alive\r\n"
+    "Cache-Control: max-age=0\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_12_0) AppleWebKit/537.36 "
+      "(KHTML, like Gecko) Chrome/53.0.2785.143 Safari/537.36\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/webp,*/*;q=0.8\r\n"
+    "Referer: https://www.google.com/\r\n"
+    "Accept-Encoding: gzip, deflate, sdch, br\r\n"
+    "Accept-Language: en-US,en;q=0.8,nb;q=0.6\r\n"
+    "Cookie: _ga=GA1.2.1702377435.1474893472; _gid=GA1.2.1702377435; session=f3a9c0e1d2b4\r\n"
+    "If-None-Match: W/\"5a3f-1579e5c8a10\"\r\n"
+    "If-Modified-Since: Sat, 17 Sep 2016 10:00:00 GMT\r\n"
+    "DNT: 1\r\n"
+    "Via: 1.1 varnish, 1.1 cloudfront\r\n"
+    "X-Forwarded-For: 203.0.113.7, 198.51.100.23\r\n"
+    "X-Forwarded-Proto: https\r\n"
+    "X-Forwarded-Port: 443\r\n"
+    "X-Amz-Cf-Id: 0Hl9pF6Lq8vKxJ1dXo2Qz3kTn4Yw5Rm6Sb7Uc8Vd9We0Xf1Yg2Zh3A==\r\n"
+    "CloudFront-Is-Mobile-Viewer: false\r\n"
+    "CloudFront-Viewer-Country: NO\r\n"
+    "\r\n"
+  };
+
+  const auto old_ns = bench::run("per-character add_fields (20 fields)", 100000, [&] {
+    Header header {25};
+    legacy::add_fields(header, fields);
+    bench::keep(header.size());
+  });
+
+  const auto new_ns = bench::run("Header::add_fields (20 fields)", 100000, [&] {
+    Header header {fields, 25};
+    bench::keep(header.size());
+  });
+
+  std::printf("speedup: %.1fx\n\n", old_ns / new_ns);
+
+  auto scan = [&fields](scanner::Block_mask mask) {
+    const auto end = fields.data() + fields.size();
+    Delimiter_scanner scanner {fields.data(), end, mask};
+    std::size_t count {0};
+    for (auto p = scanner.next(fields.data()); p not_eq end; p = scanner.next(p + 1)) ++count;
+    bench::keep(count);
+  };
+
+  bench::run("delimiter scan, scalar", 200000, [&] { scan(scanner::mask_scalar); });
+#ifdef HTTP_SCANNER_X86
+  bench::run("delimiter scan, SSE2", 200000, [&] { scan(scanner::mask_sse2); });
+  if (__builtin_cpu_supports("avx2")) {
+    bench::run("delimiter scan, AVX2", 200000, [&] { scan(scanner::mask_avx2); });
+  }
+#endif
+}
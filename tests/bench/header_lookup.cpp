@@ -0,0 +1,112 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Header lookups: hashed case-insensitive find and well-known
+// identifiers against the former lower-case-copy comparison
+
+#include <request_view.hpp>
+
+#include "bench.hpp"
+#include "allocations.hpp"
+
+using namespace http;
+
+namespace legacy {
+
+inline std::string string_to_lower_case(std::string s) {
+  std::transform(s.begin(), s.end(), s.begin(), ::tolower);
+  return s;
+}
+
+// The former Header::find over the same fields
+inline bool has_field(const Header_set& fields, const std::string& field) {
+  return
+  std::find_if(fields.begin(), fields.end(), [&field](const auto& f) {
+    return string_to_lower_case(f.first) == string_to_lower_case(field);
+  }) not_eq fields.end();
+}
+
+} //< namespace legacy
+
+int main() {
+  const std::string ingress {
+    "POST /api/v1/reports HTTP/1.1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:49.0) Gecko/20100101 Firefox/49.0\r\n"
+    "Accept: application/json\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://www.includeos.org/dashboard\r\n"
+    "Content-Type: application/json\r\n"
+    "Origin: https://www.includeos.org\r\n"
+    "Cookie: session=f3a9c0e1d2b4\r\n"
+    "DNT: 1\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Pragma: no-cache\r\n"
+    "X-Requested-With: XMLHttpRequest\r\n"
+    "X-Forwarded-For: 203.0.113.7\r\n"
+    "X-Forwarded-Proto: https\r\n"
+    "Via: 1.1 varnish\r\n"
+    "TE: trailers\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Host: www.includeos.org\r\n"
+    "Connection: keep-alive\r\n"
+    "Content-Length: 2\r\n"
+    "\r\n"
+    "{}"
+  };
+
+  const Request request {ingress};
+
+  Header_set fields;
+  Request_view view {ingress.data(), ingress.size()};
+  for (const auto& f : view) fields.emplace_back(std::string{f.name}, std::string{f.value});
+
+  const std::string host       {"Host"};
+  const std::string connection {"connection"};
+  const std::string length     {"Content-Length"};
+  const std::string missing    {"If-None-Match"};
+
+  auto lookups = [&](auto&& has) {
+    bench::keep(has(host));
+    bench::keep(has(connection));
+    bench::keep(has(length));
+    bench::keep(has(missing));
+  };
+
+  bench::allocations = 0;
+  const auto old_ns = bench::run("lower-case-copy lookups (4 on 21 fields)", 100000, [&] {
+    lookups([&fields](const std::string& f) { return legacy::has_field(fields, f); });
+  });
+  std::printf("  allocations per lookup: %.1f\n", bench::allocations / (4 * 110001.0));
+
+  bench::allocations = 0;
+  const auto new_ns = bench::run("hashed lookups (4 on 21 fields)", 100000, [&] {
+    lookups([&request](const std::string& f) { return request.has_header(f); });
+  });
+  std::printf("  allocations per lookup: %.1f\n", bench::allocations / (4 * 110001.0));
+
+  std::printf("speedup: %.1fx\n", old_ns / new_ns);
+
+  const auto id_ns = bench::run("identifier lookups (4 on 21 fields)", 100000, [&] {
+    bench::keep(request.has_header(Header_id::Host));
+    bench::keep(request.has_header(Header_id::Connection));
+    bench::keep(request.has_header(Header_id::Content_Length));
+    bench::keep(request.has_header(Header_id::If_None_Match));
+  });
+
+  std::printf("speedup over hashed lookups: %.1fx\n", new_ns / id_ns);
+}
@@ -0,0 +1,83 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Header storage: heap footprint and lookups of the flat field buffer
+// against the former vector of string pairs
+
+#include <header.hpp>
+
+#include "bench.hpp"
+#include "allocations.hpp"
+
+using namespace http;
+
+int main() {
+  const std::string section {
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:49.0) Gecko/20100101 Firefox/49.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://www.includeos.org/dashboard\r\n"
+    "Cookie: session=f3a9c0e1d2b4; theme=dark; consent=analytics,functional\r\n"
+    "DNT: 1\r\n"
+    "X-Forwarded-For: 203.0.113.7\r\n"
+    "Host: www.includeos.org\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+  };
+
+  const Header header {section};
+
+  // The former layout: one pair of strings per field
+  bench::allocations = bench::allocated_bytes = 0;
+  Header_set pairs;
+  pairs.reserve(25);
+  for (const auto field : header) pairs.emplace_back(std::string{field.name}, std::string{field.value});
+  std::printf("%-48s %8zu bytes in %zu allocations\n", "vector of string pairs (10 fields)",
+              bench::allocated_bytes, bench::allocations);
+
+  bench::allocations = bench::allocated_bytes = 0;
+  const Header flat {section};
+  std::printf("%-48s %8zu bytes in %zu allocations\n", "flat header (10 fields)",
+              bench::allocated_bytes, bench::allocations);
+
+  const std::string_view names[] {"cookie", "X-Forwarded-For", "Connection", "If-None-Match"};
+
+  bench::run("scan of string pairs (4 lookups)", 1000000, [&] {
+    for (const auto name : names) {
+      bench::keep(std::find_if(pairs.begin(), pairs.end(), [name](const auto& f) {
+        return iequals(f.first, name);
+      }) not_eq pairs.end());
+    }
+  });
+
+  bench::run("flat header (4 lookups)", 1000000, [&] {
+    for (const auto name : names) bench::keep(header.get_value(name).data());
+  });
+
+  bench::run("iterate string pairs", 1000000, [&] {
+    std::size_t size {0};
+    for (const auto& f : pairs) size += f.first.size() + f.second.size();
+    bench::keep(size);
+  });
+
+  bench::run("iterate flat header", 1000000, [&] {
+    std::size_t size {0};
+    for (const auto f : header) size += f.name.size() + f.value.size();
+    bench::keep(size);
+  });
+}
@@ -0,0 +1,65 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// MIME lookups: the built-in and a loaded perfect hash table against
+// the former unordered_map keyed by std::string
+
+#include <string>
+#include <unordered_map>
+#include <mime_types.hpp>
+
+#include "bench.hpp"
+
+using namespace http;
+
+int main() {
+  std::unordered_map<std::string, std::string> legacy;
+  for (const auto& mapping : mime_types) {
+    legacy.emplace(std::string{mapping.extension}, std::string{mapping.type});
+  }
+
+  const char* paths[] {
+    "/index.html", "/static/app.min.js?v=2", "/img/logo.png", "/fonts/a.woff2", "/README"
+  };
+
+  // The caller had to extract the extension and build a key
+  const auto old_ns = bench::run("unordered_map lookups (5 paths)", 1000000, [&] {
+    for (const auto path : paths) {
+      const auto ext  = path_extension(path);
+      const auto type = legacy.find(std::string{ext});
+      bench::keep(type == legacy.end() ? nullptr : type->second.data());
+    }
+  });
+
+  const auto new_ns = bench::run("path_to_type (5 paths)", 1000000, [&] {
+    for (const auto path : paths) bench::keep(path_to_type(path).data());
+  });
+
+  std::printf("speedup: %.1fx\n", old_ns / new_ns);
+
+  try {
+    Mime_table table;
+    bench::once("load /etc/mime.types", [&] { table = Mime_table::from_file("/etc/mime.types"); });
+    std::printf("  extensions: %zu\n", table.size());
+    load_mime_types(std::move(table));
+    bench::run("path_to_type with /etc/mime.types (5 paths)", 1000000, [&] {
+      for (const auto path : paths) bench::keep(path_to_type(path).data());
+    });
+  } catch (const Mime_table_error& e) {
+    std::printf("  skipped: %s\n", e.what());
+  }
+}
@@ -0,0 +1,73 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A keep-alive connection serving one request after another: fresh
+// message objects against objects recycled through the thread's pool
+
+#include <pool.hpp>
+
+#include "bench.hpp"
+#include "allocations.hpp"
+
+using namespace http;
+
+int main() {
+  const std::string ingress {
+    "GET /api/v1/reports HTTP/1.1\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:49.0) Gecko/20100101 Firefox/49.0\r\n"
+    "Accept: application/json\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Referer: https://www.includeos.org/dashboard\r\n"
+    "Cookie: session=f3a9c0e1d2b4\r\n"
+    "Host: www.includeos.org\r\n"
+    "Connection: keep-alive\r\n"
+    "\r\n"
+  };
+
+  const std::string body (2048, 'x');
+  constexpr std::size_t requests {100000};
+
+  bench::allocations = 0;
+  const auto old_ns = bench::run("fresh request and response", requests, [&] {
+    auto request  = std::make_unique<Request>(std::string{ingress});
+    auto response = std::make_unique<Response>(OK);
+    response->add_header(header_fields::Response::Server, "IncludeOS/0.7.0")
+             .add_header(header_fields::Entity::Content_Type, "application/json")
+             .add_body(std::string{body});
+    bench::keep(response->export_iovecs()[2].length);
+    bench::keep(request->method());
+  });
+  std::printf("  allocations per request: %.1f\n", bench::allocations / (requests * 1.1 + 1));
+
+  bench::allocations = 0;
+  const auto new_ns = bench::run("pooled request and response", requests, [&] {
+    auto request  = acquire_request(ingress);
+    auto response = acquire_response(OK);
+    response->add_header(header_fields::Response::Server, "IncludeOS/0.7.0")
+             .add_header(header_fields::Entity::Content_Type, "application/json")
+             .add_body(body);
+    bench::keep(response->export_iovecs()[2].length);
+    bench::keep(request->method());
+  });
+  std::printf("  allocations per request: %.1f\n", bench::allocations / (requests * 1.1 + 1));
+
+  std::printf("speedup: %.1fx\n", old_ns / new_ns);
+
+  const auto& stats = Pool<Request>::local().stats();
+  std::printf("request pool: hit rate %.4f, high-water mark %zu\n", stats.hit_rate(), stats.high_water);
+}
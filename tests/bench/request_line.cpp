@@ -0,0 +1,124 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Request-Line parsing: hand-written parser against the former std::regex
+// path, and method recognition against the former map lookup
+
+#include <regex>
+#include <unordered_map>
+#include <request_line.hpp>
+
+#include "bench.hpp"
+
+using namespace http;
+
+namespace legacy {
+
+struct Parts {
+  Method      method;
+  std::string target;
+  unsigned    major;
+  unsigned    minor;
+};
+
+// The former method::code
+inline Method code(const std::string& method) noexcept {
+  const static std::unordered_map<std::string, Method> code_map {
+    {"GET",     GET},
+    {"POST",    POST},
+    {"PUT",     PUT},
+    {"DELETE",  DELETE},
+    {"OPTIONS", OPTIONS},
+    {"HEAD",    HEAD},
+    {"TRACE",   TRACE},
+    {"CONNECT", CONNECT},
+    {"PATCH",   PATCH}
+  };
+
+  auto it = code_map.find(method);
+
+  return (it not_eq code_map.end()) ? it->second : INVALID;
+}
+
+// The parsing steps of the former Request_line(T&&) constructor
+inline Parts parse(const std::string& request) {
+  std::string request_line = request.substr(0, request.find("\r\n"));
+
+  const static std::regex request_line_pattern
+  {
+    "\\s*(GET|POST|PUT|DELETE|OPTIONS|HEAD|TRACE|CONNECT) " // Method
+    "(\\S+) " // URI
+    "HTTP/(\\d+)\\.(\\d+)" // Version Major.Minor
+  };
+
+  std::smatch m;
+
+  if (not std::regex_match(request_line, m, request_line_pattern)) {
+    throw Request_line_error("Invalid request line: " + request_line);
+  }
+
+  return {
+    code(m[1]),
+    m[2],
+    static_cast<unsigned>(std::stoul(m[3])),
+    static_cast<unsigned>(std::stoul(m[4]))
+  };
+}
+
+} //< namespace legacy
+
+int main() {
+  const std::string request {
+    "GET /static/js/app.bundle.js?v=20161003 HTTP/1.1\r\n"
+    "Host: includeos.server:8080\r\n\r\n"
+  };
+
+  const auto data = request.data();
+  const auto end  = data + request.size();
+
+  bench::once("first request, regex (includes construction)", [&] {
+    bench::keep(legacy::parse(request).major);
+  });
+
+  bench::once("first request, hand-written", [&] {
+    Request_line_parts parts;
+    bench::keep(parse_request_line(data, end, parts));
+  });
+
+  const auto old_ns = bench::run("regex Request-Line", 200000, [&] {
+    bench::keep(legacy::parse(request).major);
+  });
+
+  const auto new_ns = bench::run("parse_request_line", 200000, [&] {
+    Request_line_parts parts;
+    bench::keep(parse_request_line(data, end, parts));
+  });
+
+  std::printf("speedup: %.1fx\n", old_ns / new_ns);
+
+  const std::string tokens[] {"GET", "POST", "DELETE", "OPTIONS", "PATCH"};
+
+  const auto old_code_ns = bench::run("method map lookup (5 tokens)", 200000, [&] {
+    for (const auto& token : tokens) bench::keep(legacy::code(std::string{token.data(), token.size()}));
+  });
+
+  const auto new_code_ns = bench::run("method::code (5 tokens)", 200000, [&] {
+    for (const auto& token : tokens) bench::keep(method::code(std::string_view{token}));
+  });
+
+  std::printf("speedup: %.1fx\n", old_code_ns / new_code_ns);
+}
@@ -0,0 +1,119 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Response serialization: exact-size single pass against the former
+// chain of ostringstreams, status-lines from the compile-time table,
+// and scatter-gather export of a large body
+
+#include <sstream>
+#include <response.hpp>
+
+#include "bench.hpp"
+#include "allocations.hpp"
+
+using namespace http;
+
+namespace legacy {
+
+// The former Status_line, Header, Message and Response to_string
+inline std::string to_string(const Code code, const Header_set& fields, const std::string& body) {
+  std::ostringstream version;
+  version << "HTTP/" << 1 << "." << 1;
+  //-----------------------------------
+  std::ostringstream status_line;
+  status_line << version.str() << " " << code << " " << code_description(code) << "\r\n";
+  //-----------------------------------
+  std::ostringstream header;
+  for (const auto& field : fields) header << field.first << ": " << field.second << "\r\n";
+  header << "\r\n";
+  //-----------------------------------
+  std::ostringstream message;
+  message << header.str() << body;
+  //-----------------------------------
+  std::ostringstream res;
+  res << status_line.str() << message.str();
+  return res.str();
+}
+
+} //< namespace legacy
+
+int main() {
+  const Header_set fields {
+    {"Server",         "IncludeOS/v0.9"},
+    {"Content-Type",   "application/json"},
+    {"Connection",     "keep-alive"},
+    {"Cache-Control",  "no-cache"}
+  };
+  const std::string body(512, 'x');
+
+  Response response;
+  response << fields;
+  response.add_body(body);
+
+  Header_set legacy_fields {fields};
+  legacy_fields.emplace_back("Content-Length", "512");
+
+  bench::allocations = 0;
+  const auto old_ns = bench::run("ostringstream chain (200, 5 fields, 512 B)", 100000, [&] {
+    bench::keep(legacy::to_string(OK, legacy_fields, body));
+  });
+  std::printf("  allocations per response: %.1f\n", bench::allocations / 110001.0);
+
+  bench::allocations = 0;
+  const auto new_ns = bench::run("to_string (200, 5 fields, 512 B)", 100000, [&] {
+    bench::keep(response.to_string());
+  });
+  std::printf("  allocations per response: %.1f\n", bench::allocations / 110001.0);
+
+  char buffer[2048];
+  bench::allocations = 0;
+  const auto into_ns = bench::run("serialize_into caller buffer", 100000, [&] {
+    bench::keep(response.serialize_into(buffer));
+  });
+  std::printf("  allocations per response: %.1f\n", bench::allocations / 110001.0);
+
+  std::printf("speedup: %.1fx (to_string) %.1fx (serialize_into)\n", old_ns / new_ns, old_ns / into_ns);
+
+  const Status_line status_line {Version{1, 1}, Not_Found};
+  const auto old_sl_ns = bench::run("status-line via ostringstream", 100000, [&] {
+    std::ostringstream line;
+    line << "HTTP/" << 1 << "." << 1 << " " << Not_Found << " " << code_description(Not_Found) << "\r\n";
+    bench::keep(line.str());
+  });
+  const auto new_sl_ns = bench::run("status-line from table into caller buffer", 100000, [&] {
+    bench::keep(status_line.serialize_into(buffer));
+  });
+  std::printf("speedup: %.1fx\n", old_sl_ns / new_sl_ns);
+
+  Response asset;
+  asset << fields;
+  asset.add_body(std::string(1 << 20, 'x'));
+
+  bench::allocations = 0;
+  const auto copy_ns = bench::run("to_string (200, 1 MB body)", 1000, [&] {
+    bench::keep(asset.to_string());
+  });
+  std::printf("  allocations per response: %.1f\n", bench::allocations / 1101.0);
+
+  bench::allocations = 0;
+  const auto iov_ns = bench::run("export_iovecs (200, 1 MB body)", 1000, [&] {
+    bench::keep(asset.export_iovecs());
+  });
+  std::printf("  allocations per response: %.1f\n", bench::allocations / 1101.0);
+
+  std::printf("speedup: %.1fx\n", copy_ns / iov_ns);
+}
@@ -0,0 +1,43 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Boot-time static initialization: time and allocations spent before
+// main in a program whose translation units all include <http>
+//
+// Link with several copies of static_init_tu.cpp (see the Makefile)
+// to see how the cost scales with the number of translation units
+
+#include <chrono>
+#include <cstdio>
+
+#include "allocations.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+static Clock::time_point start;
+
+// Runs ahead of every default-priority static initializer
+__attribute__((constructor(101))) static void mark_start() {
+  start              = Clock::now();
+  bench::allocations = 0;
+}
+
+int main() {
+  const auto ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+  std::printf("%-48s %12.1f ns\n", "static initialization before main", ns);
+  std::printf("  allocations: %zu\n", bench::allocations);
+}
@@ -0,0 +1,32 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A translation unit that includes <http> and the MIME table; the
+// Makefile compiles it several times with distinct TU_ID values
+
+#include <http>
+#include <mime_types.hpp>
+
+#ifndef TU_ID
+#define TU_ID 0
+#endif
+
+#define HTTP_BENCH_CONCAT(a, b) a##b
+#define HTTP_BENCH_NAME(a, b)   HTTP_BENCH_CONCAT(a, b)
+
+// Gives every copy a distinct external symbol
+int HTTP_BENCH_NAME(static_init_tu_, TU_ID)() { return TU_ID; }
@@ -0,0 +1,267 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// 
+//     http://www.apache.org/licenses/LICENSE-2.0
+// 
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <catch.hpp>
+#include <parser.hpp>
+
+#define CRLF "\r\n"
+
+using namespace std;
+using namespace http;
+
+using Status = Parser::Status;
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request split across segments", "[Parser]") {
+  Parser parser {Parser::Mode::Request};
+  string body;
+  parser.on_body([&body](string_view data) { body.append(data.data(), data.size()); });
+  //-------------------------
+  const string first  = "POST /upload HTTP/1.1" CRLF "Host: includeos.serv";
+  const string second = "er:8080" CRLF "Content-Length: 11" CRLF CRLF "Hello ";
+  const string third  = "World";
+  //-------------------------
+  REQUIRE(parser.feed(first.data(), first.size()) == Status::Need_more);
+  REQUIRE(parser.consumed() == first.size());
+  //-------------------------
+  REQUIRE(parser.feed(second.data(), second.size()) == Status::Headers_complete);
+  REQUIRE(parser.method()         == POST);
+  REQUIRE(parser.content_length() == 11);
+  REQUIRE(parser.request_view().header_value("Host") == "includeos.server:8080");
+  //-------------------------
+  auto rest = second.size() - parser.consumed();
+  REQUIRE(parser.feed(second.data() + parser.consumed(), rest) == Status::Need_more);
+  REQUIRE(parser.feed(third.data(), third.size()) == Status::Message_complete);
+  REQUIRE(body == "Hello World");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Parsing stops at the end of a message", "[Parser]") {
+  Parser parser {Parser::Mode::Request};
+  //-------------------------
+  const string ingress = "GET / HTTP/1.1" CRLF "Host: a" CRLF CRLF
+                         "GET /next HTTP/1.1" CRLF CRLF;
+  //-------------------------
+  REQUIRE(parser.feed(ingress.data(), ingress.size()) == Status::Message_complete);
+  REQUIRE(parser.consumed() == 27);
+  REQUIRE(parser.request().header_value("Host"s) == "a");
+  //-------------------------
+  parser.reset();
+  REQUIRE(parser.feed(ingress.data() + 27, ingress.size() - 27) == Status::Message_complete);
+  REQUIRE(parser.request_view().target() == "/next");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Response body delimited by the end of the connection", "[Parser]") {
+  Parser parser {Parser::Mode::Response};
+  size_t received {0};
+  parser.on_body([&received](string_view data) { received += data.size(); });
+  //-------------------------
+  const string egress = "HTTP/1.0 200 OK" CRLF "Server: upstream" CRLF CRLF "0123456789";
+  //-------------------------
+  REQUIRE(parser.feed(egress.data(), egress.size()) == Status::Headers_complete);
+  REQUIRE(parser.has_content_length() == false);
+  REQUIRE(parser.response().header_value("Server"s) == "upstream");
+  //-------------------------
+  auto rest = egress.size() - parser.consumed();
+  REQUIRE(parser.feed(egress.data() + parser.consumed(), rest) == Status::Need_more);
+  REQUIRE(parser.finish() == Status::Message_complete);
+  REQUIRE(received == 10);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Oversized head is rejected", "[Parser]") {
+  Parser parser {Parser::Mode::Request, 32};
+  //-------------------------
+  const string ingress = "GET / HTTP/1.1" CRLF "User-Agent: a rather long agent string" CRLF CRLF;
+  //-------------------------
+  REQUIRE_THROWS_AS(parser.feed(ingress.data(), ingress.size()), const Parser_error&);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Chunked body decoded one byte at a time", "[Parser]") {
+  Parser parser {Parser::Mode::Request};
+  string body;
+  parser.on_body([&body](string_view data) { body.append(data.data(), data.size()); });
+  //-------------------------
+  const string ingress = "POST /upload HTTP/1.1" CRLF "Transfer-Encoding: gzip, Chunked" CRLF CRLF
+                         "5;name=\"va;lue\"" CRLF "Hello" CRLF "6" CRLF " World" CRLF
+                         "0" CRLF "Checksum: abc" CRLF CRLF "GET / HTTP/1.1";
+  //-------------------------
+  auto status = Status::Need_more;
+  size_t offset {0};
+  while (status not_eq Status::Message_complete) {
+    status  = parser.feed(ingress.data() + offset, 1);
+    offset += parser.consumed();
+  }
+  REQUIRE(parser.is_chunked());
+  REQUIRE(body == "Hello World");
+  REQUIRE(parser.trailers().get_value("Checksum") == "abc");
+  REQUIRE(ingress.substr(offset) == "GET / HTTP/1.1");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Chunked decoder reports extensions and enforces its limits", "[Parser]") {
+  vector<pair<string, string>> extensions;
+  Chunked_decoder decoder {8};
+  decoder.on_extension([&extensions](string_view name, string_view value) {
+    extensions.emplace_back(name, value);
+  });
+  //-------------------------
+  const string chunks = "4 ; a=1;b=\"x\\\"y\";c" CRLF "abcd" CRLF "5" CRLF "efghi" CRLF;
+  //-------------------------
+  REQUIRE_THROWS_AS(decoder.feed(chunks.data(), chunks.size()), const Chunked_error&);
+  REQUIRE(extensions.size() == 3);
+  REQUIRE(extensions[1] == make_pair("b"s, "x\\\"y"s));
+  REQUIRE(extensions[2] == make_pair("c"s, ""s));
+  //-------------------------
+  const vector<string> malformed {
+    "g" CRLF,
+    "1234567890abcdef0" CRLF,
+    "1" CRLF "ab" CRLF,
+    "0" CRLF "Content-Length: 3" CRLF CRLF,
+    "0" CRLF "X: 1" CRLF " folded" CRLF CRLF
+  };
+  for (const auto& input : malformed) {
+    decoder.reset();
+    REQUIRE_THROWS_AS(decoder.feed(input.data(), input.size()), const Chunked_error&);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Ambiguous or oversized bodies are rejected", "[Parser]") {
+  const vector<string> rejected {
+    "POST / HTTP/1.1" CRLF "Transfer-Encoding: chunked" CRLF "Content-Length: 4" CRLF CRLF,
+    "POST / HTTP/1.1" CRLF "Transfer-Encoding: chunked, gzip" CRLF CRLF,
+    "POST / HTTP/1.1" CRLF "Content-Length: 17" CRLF CRLF,
+    "POST / HTTP/1.1" CRLF "Transfer-Encoding: chunked" CRLF CRLF "11" CRLF
+  };
+  for (const auto& ingress : rejected) {
+    Parser parser {Parser::Mode::Request};
+    parser.set_max_body_size(16);
+    REQUIRE_THROWS_AS([&] {
+      for (size_t offset {0}; offset < ingress.size(); offset += parser.consumed()) {
+        parser.feed(ingress.data() + offset, ingress.size() - offset);
+      }
+    }(), const Parser_error&);
+  }
+  //-------------------------
+  Parser parser {Parser::Mode::Request};
+  const string partial = "POST / HTTP/1.1" CRLF "Transfer-Encoding: chunked" CRLF CRLF "3" CRLF "ab";
+  REQUIRE(parser.feed(partial.data(), partial.size()) == Status::Headers_complete);
+  auto rest = partial.size() - parser.consumed();
+  REQUIRE(parser.feed(partial.data() + parser.consumed(), rest) == Status::Need_more);
+  REQUIRE_THROWS_AS(parser.finish(), const Parser_error&);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Other transfer codings and the body size cap on responses read to close", "[Parser]") {
+  // Without chunked as the final coding the body runs to the end of the connection
+  Parser encoded {Parser::Mode::Response};
+  size_t received {0};
+  encoded.on_body([&received](string_view data) { received += data.size(); });
+  //-------------------------
+  const string egress = "HTTP/1.1 200 OK" CRLF "Transfer-Encoding: gzip" CRLF
+                        "Content-Length: 2" CRLF CRLF "0123456789";
+  //-------------------------
+  REQUIRE(encoded.feed(egress.data(), egress.size()) == Status::Headers_complete);
+  REQUIRE(encoded.has_content_length() == false);
+  auto rest = egress.size() - encoded.consumed();
+  REQUIRE(encoded.feed(egress.data() + encoded.consumed(), rest) == Status::Need_more);
+  REQUIRE(encoded.finish() == Status::Message_complete);
+  REQUIRE(received == 10);
+  //-------------------------
+  Parser capped {Parser::Mode::Response};
+  capped.set_max_body_size(8);
+  REQUIRE(capped.feed(egress.data(), egress.size()) == Status::Headers_complete);
+  REQUIRE_THROWS_AS(capped.feed(egress.data() + capped.consumed(), rest), const Parser_error&);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("The head of a response is copied without its body", "[Parser]") {
+  const vector<string> heads {
+    "HTTP/1.1 200 OK" CRLF "Content-Length: 4" CRLF CRLF,
+    "HTTP/1.1 200 OK" CRLF "Transfer-Encoding: chunked" CRLF CRLF
+  };
+  for (const auto& egress : heads) {
+    Parser parser {Parser::Mode::Response};
+    REQUIRE(parser.feed(egress.data(), egress.size()) == Status::Headers_complete);
+    //-------------------------
+    const auto response = parser.response();
+    REQUIRE(response.status_code() == OK);
+    REQUIRE(response.header_size() == 1);
+    REQUIRE(response.get_body().empty());
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("The parsers agree on malformed field lines", "[Parser]") {
+  const vector<string> heads {
+    "POST / HTTP/1.1" CRLF "Content-Length : 5" CRLF CRLF "Hello",
+    "POST / HTTP/1.1" CRLF "Content-Length\t: 5" CRLF CRLF "Hello",
+    "POST / HTTP/1.1" CRLF " Content-Length: 5" CRLF CRLF "Hello",
+    "POST / HTTP/1.1" CRLF "Host: a\rContent-Length: 5" CRLF CRLF "Hello",
+    "POST / HTTP/1.1" CRLF "Content-Length: 5\rX: y" CRLF CRLF "Hello"
+  };
+  for (const auto& ingress : heads) {
+    Parser parser {Parser::Mode::Request};
+    REQUIRE_THROWS_AS(parser.feed(ingress.data(), ingress.size()), const Parser_error&);
+    REQUIRE_THROWS_AS((Request_view{ingress.data(), ingress.size()}), const Request_view_error&);
+    REQUIRE_THROWS_AS(Request{ingress}, const Message_error&);
+    REQUIRE_THROWS_AS(Request{}.parse_next(ingress), const Message_error&);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("A response to HEAD has no body", "[Parser]") {
+  const string egress = "HTTP/1.1 200 OK" CRLF "Content-Length: 5" CRLF CRLF
+                        "HTTP/1.1 200 OK" CRLF "Content-Length: 5" CRLF CRLF "Hello";
+  //-------------------------
+  Parser parser {Parser::Mode::Response};
+  string body;
+  parser.on_body([&body](string_view data) { body.append(data.data(), data.size()); });
+  //-------------------------
+  parser.set_request_method(HEAD);
+  REQUIRE(parser.feed(egress.data(), egress.size()) == Status::Message_complete);
+  REQUIRE(parser.content_length() == 0);
+  const auto first = parser.consumed();
+  REQUIRE(first == 38);
+  //-------------------------
+  parser.reset();
+  REQUIRE(parser.feed(egress.data() + first, egress.size() - first) == Status::Headers_complete);
+  const auto head = parser.consumed();
+  REQUIRE(parser.feed(egress.data() + first + head, egress.size() - first - head) == Status::Message_complete);
+  REQUIRE(body == "Hello");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("A connection closed between messages is not an error", "[Parser]") {
+  Parser parser {Parser::Mode::Request};
+  REQUIRE(parser.finish() == Status::Need_more);
+  //-------------------------
+  const string ingress = "GET / HTTP/1.1" CRLF CRLF CRLF;
+  REQUIRE(parser.feed(ingress.data(), ingress.size()) == Status::Message_complete);
+  REQUIRE(parser.finish() == Status::Message_complete);
+  const auto taken = parser.consumed();
+  //-------------------------
+  parser.reset();
+  REQUIRE(parser.feed(ingress.data() + taken, ingress.size() - taken) == Status::Need_more);
+  REQUIRE(parser.finish() == Status::Need_more);
+  //-------------------------
+  REQUIRE(parser.feed("GET", 3) == Status::Need_more);
+  REQUIRE_THROWS_AS(parser.finish(), const Parser_error&);
+}
@@ -15,8 +15,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory_resource>
 #include <catch.hpp>
+#include <pool.hpp>
 #include <request.hpp>
+#include <request_view.hpp>
 
 #define CRLF "\r\n"
 
@@ -78,7 +81,8 @@ TEST_CASE("Handling query data", "[Request]") {
 TEST_CASE("Handling post data", "[Request]") {
   string ingress = "POST / HTTP/1.1" CRLF
                    "Host: includeos.server:8080" CRLF
-                   "Connection: close" CRLF CRLF
+                   "Connection: close" CRLF
+                   "Content-Length: 40" CRLF CRLF
                    "name=rico&language=cpp&project=includeos";
   //-------------------------
   Request request {std::move(ingress)};
@@ -108,3 +112,534 @@ TEST_CASE("Header value folding", "[Request]") {
   //-------------------------
   REQUIRE(test_string == request.to_string());
 }
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request_view parses in place", "[Request_view]") {
+  const string ingress = "POST /upload?id=7 HTTP/1.1" CRLF
+                         "Host: includeos.server:8080" CRLF
+                         "Content-Type: text/plain" CRLF
+                         "Content-Length: 20" CRLF CRLF
+                         "Hello from IncludeOS";
+  //-------------------------
+  Request_view view {ingress.data(), ingress.size()};
+  //-------------------------
+  REQUIRE(view.method()                     == "POST");
+  REQUIRE(view.target()                     == "/upload?id=7");
+  REQUIRE(view.version()                    == "HTTP/1.1");
+  REQUIRE(view.header_size()                == 3);
+  REQUIRE(view.header_value("host")         == "includeos.server:8080");
+  REQUIRE(view.has_header("Content-Type")   == true);
+  REQUIRE(view.body()                       == "Hello from IncludeOS");
+  REQUIRE(view.consumed()                   == ingress.size());
+  //-------------------------
+  // Every component points into the original bytes
+  REQUIRE(view.body().data()   >= ingress.data());
+  REQUIRE(view.body().data()   <  ingress.data() + ingress.size());
+  REQUIRE(view.target().data() == ingress.data() + 5);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request_view copies into an owning request", "[Request_view]") {
+  const string ingress = "GET / HTTP/1.0" CRLF
+                         "Accept: text/plain;q=0.2," CRLF
+                         "        text/html;q=0.9" CRLF
+                         "Connection: close" CRLF CRLF;
+  //-------------------------
+  Request request = Request_view{ingress.data(), ingress.size()}.to_request();
+  //-------------------------
+  REQUIRE(request.method()                == GET);
+  REQUIRE(request.version()               == Version(1, 0));
+  REQUIRE(request.header_value("Accept"s) == "text/plain;q=0.2, text/html;q=0.9");
+  //-------------------------
+  const string upload = "POST /upload HTTP/1.1" CRLF "Content-Length: 11" CRLF CRLF "Hello";
+  Request partial = Request_view{upload.data(), upload.size()}.to_request();
+  REQUIRE(partial.get_body() == "Hello");
+  REQUIRE(partial.header_value("Content-Length"s) == "11");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request_view frames the body by its framing fields", "[Request_view]") {
+  const string first  = "POST /a HTTP/1.1" CRLF "Content-Length: 5" CRLF CRLF "Hello";
+  const string second = "GET /admin HTTP/1.1" CRLF CRLF;
+  const string ingress = first + second;
+  //-------------------------
+  Request_view view {ingress.data(), ingress.size()};
+  REQUIRE(view.body()     == "Hello");
+  REQUIRE(view.consumed() == first.size());
+  REQUIRE(view.to_request().get_body() == "Hello");
+  //-------------------------
+  // Without framing fields there is no body
+  Request_view bare {ingress.data() + first.size(), second.size() + 5};
+  REQUIRE(bare.body().empty());
+  REQUIRE(bare.consumed() == second.size());
+  //-------------------------
+  // A chunked body is left to the caller
+  const string chunked = "POST /b HTTP/1.1" CRLF "Transfer-Encoding: chunked" CRLF CRLF "5" CRLF "Hello" CRLF "0" CRLF CRLF;
+  Request_view encoded {chunked.data(), chunked.size()};
+  REQUIRE(encoded.is_chunked());
+  REQUIRE(encoded.body().empty());
+  REQUIRE(encoded.consumed() == chunked.find("5" CRLF));
+  //-------------------------
+  const vector<string> invalid {
+    "POST / HTTP/1.1" CRLF "Content-Length: 5" CRLF "Content-Length: 6" CRLF CRLF "Hello!",
+    "POST / HTTP/1.1" CRLF "Content-Length: 5" CRLF "Transfer-Encoding: chunked" CRLF CRLF "Hello",
+    "POST / HTTP/1.1" CRLF "Transfer-Encoding: gzip" CRLF CRLF "Hello",
+    "POST / HTTP/1.1" CRLF "Content-Length: -5" CRLF CRLF "Hello"
+  };
+  for (const auto& request : invalid) {
+    REQUIRE_THROWS_AS((Request_view{request.data(), request.size()}), const Request_view_error&);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request_view rejects a malformed request line", "[Request_view]") {
+  const string ingress = "GET /index.html HTTP/x.1" CRLF CRLF;
+  //-------------------------
+  REQUIRE_THROWS_AS((Request_view{ingress.data(), ingress.size()}), const Request_line_error&);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request_view rejects more fields than it can hold", "[Request_view]") {
+  string ingress = "POST /upload HTTP/1.1" CRLF;
+  for (int i = 0; i < 35; ++i) ingress += "X-Field-" + to_string(i) + ": v" CRLF;
+  ingress += "Content-Length: 5" CRLF CRLF "Hello";
+  //-------------------------
+  try {
+    Request_view view {ingress.data(), ingress.size()};
+    FAIL("Field beyond the capacity of the view was dropped");
+  } catch (const Request_view_error& error) {
+    REQUIRE(error.status_code() == Request_Header_Fields_Too_Large);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request-Line parser accepts LF line-endings and leading whitespace", "[Request_line]") {
+  const string ingress = "  DELETE /items/42 HTTP/1.0\n\n";
+  //-------------------------
+  Request_line_parts parts;
+  auto next = parse_request_line(ingress.data(), ingress.data() + ingress.size(), parts);
+  //-------------------------
+  REQUIRE(parts.method == DELETE);
+  REQUIRE(parts.target == "/items/42");
+  REQUIRE(parts.major  == 1);
+  REQUIRE(parts.minor  == 0);
+  REQUIRE(next         == ingress.data() + ingress.size() - 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request-Line parser reports the byte offset of an error", "[Request_line]") {
+  const string ingress = "GET /index.html HTTP/1.x" CRLF CRLF;
+  //-------------------------
+  Request_line_parts parts;
+  try {
+    parse_request_line(ingress.data(), ingress.data() + ingress.size(), parts);
+    FAIL("Expected Request_line_error");
+  } catch (const Request_line_error& error) {
+    REQUIRE(error.offset() == 23);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Parse a browser header section", "[Header]") {
+  string ingress = "GET /assets/app.css HTTP/1.1" CRLF
+                   "Host: cdn.includeos.org:8443" CRLF
+                   "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:49.0) Gecko/20100101 Firefox/49.0" CRLF
+                   "Accept: text/css,*/*;q=0.1" CRLF
+                   "Referer: https://www.includeos.org/blog/2016/09/unikernels.html" CRLF
+                   "If-Modified-Since:Sat, 17 Sep 2016 10:00:00 GMT" CRLF
+                   "X-Forwarded-For:   10.0.0.1, 10.0.0.2   " CRLF
+                   "Connection: keep-alive" CRLF CRLF
+                   "Ignored: this is the body";
+  //-------------------------
+  Request request {std::move(ingress)};
+  //-------------------------
+  REQUIRE(request.header_value("Host"s)              == "cdn.includeos.org:8443");
+  REQUIRE(request.header_value("Referer"s)           == "https://www.includeos.org/blog/2016/09/unikernels.html");
+  REQUIRE(request.header_value("If-Modified-Since"s) == "Sat, 17 Sep 2016 10:00:00 GMT");
+  REQUIRE(request.header_value("X-Forwarded-For"s)   == "10.0.0.1, 10.0.0.2");
+  REQUIRE(request.header_value("Connection"s)        == "keep-alive");
+  REQUIRE(request.has_header("Ignored"s)             == false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Vectorized and scalar delimiter scanning agree", "[Header]") {
+  string data;
+  for (int i = 0; i < 500; ++i) data += "abcdefg:\r\n hij"[(i * 7919) % 15];
+  //-------------------------
+  auto scan = [&data](scanner::Block_mask mask) {
+    vector<size_t> positions;
+    Delimiter_scanner scanner {data.data(), data.data() + data.size(), mask};
+    for (auto p = scanner.next(data.data()); p not_eq data.data() + data.size(); p = scanner.next(p + 1)) {
+      positions.push_back(p - data.data());
+    }
+    return positions;
+  };
+  //-------------------------
+  REQUIRE(scan(scanner::best_mask()) == scan(scanner::mask_scalar));
+  REQUIRE(scan(scanner::mask_scalar).size() == size_t(count_if(data.begin(), data.end(), [](char c) {
+    return c == ':' or c == '\r' or c == '\n';
+  })));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Request with LF line-endings", "[Request]") {
+  string ingress = "PUT /notes/1 HTTP/1.1\n"
+                   "Host: includeos.server:8080\n"
+                   "Content-Length: 17\n\n"
+                   "Remember the milk";
+  //-------------------------
+  Request request {std::move(ingress)};
+  //-------------------------
+  REQUIRE(request.method()              == PUT);
+  REQUIRE(request.header_value("Host"s) == "includeos.server:8080");
+  REQUIRE(request.get_body()            == "Remember the milk");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Well-known field names map onto their identifiers", "[Header]") {
+  static_assert(header_fields::id("content-length") == Header_id::Content_Length, "");
+  //-------------------------
+  for (std::size_t i = 0; i < header_fields::count; ++i) {
+    const auto id = static_cast<Header_id>(i);
+    REQUIRE(header_fields::id(header_fields::name(id)) == id);
+  }
+  //-------------------------
+  REQUIRE(header_fields::id("HOST")            == Header_id::Host);
+  REQUIRE(header_fields::id("if-none-match")   == Header_id::If_None_Match);
+  REQUIRE(header_fields::id("X-Forwarded-For") == Header_id::Unknown);
+  REQUIRE(header_fields::id("Hosts")           == Header_id::Unknown);
+  REQUIRE(header_fields::id("")                == Header_id::Unknown);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Lookup well-known header fields by identifier", "[Request]") {
+  Request request {"GET / HTTP/1.1\r\n"
+                   "host: includeos.server\r\n"
+                   "Accept-Encoding: gzip\r\n"
+                   "X-Trace: 1\r\n"
+                   "Accept-Encoding: br\r\n\r\n"s};
+  //-------------------------
+  REQUIRE(request.has_header(Header_id::Host));
+  REQUIRE(request.header_value(Header_id::Host)            == "includeos.server");
+  REQUIRE(request.header_value(Header_id::Accept_Encoding) == "gzip");
+  REQUIRE(not request.has_header(Header_id::If_None_Match));
+  REQUIRE(request.header_value(Header_id::If_None_Match).empty());
+  //-------------------------
+  request.erase_header("Accept-Encoding"s);
+  REQUIRE(request.header_value(Header_id::Accept_Encoding) == "br");
+  REQUIRE(request.header_value("X-Trace"s)                 == "1");
+  //-------------------------
+  request.clear_headers();
+  REQUIRE(not request.has_header(Header_id::Host));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Recognize standard and registered methods", "[Request_line]") {
+  REQUIRE(method::code("PATCH")   == PATCH);
+  REQUIRE(method::code("OPTIONS") == OPTIONS);
+  REQUIRE(method::code("get")     == INVALID);
+  REQUIRE(method::code("GETS")    == INVALID);
+  REQUIRE(method::str(CONNECT)    == "CONNECT");
+  //-------------------------
+  Request patch {"PATCH /notes/1 HTTP/1.1\r\n\r\n"s};
+  REQUIRE(patch.method() == PATCH);
+  //-------------------------
+  REQUIRE_THROWS_AS(Request{"PURGE /assets/app.js HTTP/1.1\r\n\r\n"s}, const Request_line_error&);
+  //-------------------------
+  const auto purge    = method::register_method("PURGE");
+  const auto propfind = method::register_method("PROPFIND");
+  REQUIRE(purge    > PATCH);
+  REQUIRE(propfind == purge + 1);
+  REQUIRE(method::register_method("PURGE") == purge);
+  REQUIRE(method::register_method("GET")   == GET);
+  REQUIRE(method::register_method("BAD METHOD") == INVALID);
+  REQUIRE(method::register_method("")      == INVALID);
+  REQUIRE(method::str(propfind)            == "PROPFIND");
+  REQUIRE(method::code("PROPFIND")         == propfind);
+  //-------------------------
+  Request request {"PURGE /assets/app.js HTTP/1.1\r\n\r\n"s};
+  REQUIRE(request.method()    == purge);
+  REQUIRE(request.to_string() == "PURGE /assets/app.js HTTP/1.1\r\n\r\n");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Recycle requests through the pool of the thread", "[Request]") {
+  const auto& stats = Pool<Request>::local().stats();
+  const auto  hits  = stats.hits;
+  //-------------------------
+  const string ingress = "POST /reports HTTP/1.1" CRLF
+                         "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:49.0)" CRLF
+                         "Content-Type: application/json" CRLF
+                         "Content-Length: 45" CRLF CRLF
+                         "{\"title\": \"A report with a long enough body\"}";
+  //-------------------------
+  const Request* first {nullptr};
+  const char*    agent {nullptr};
+  {
+    auto request = acquire_request(ingress);
+    REQUIRE(request->method() == POST);
+    REQUIRE(request->header_value(header_fields::Request::User_Agent) == "Mozilla/5.0 (X11; Linux x86_64; rv:49.0)");
+    first = request.get();
+  }
+  REQUIRE(Pool<Request>::local().idle() >= 1);
+  //-------------------------
+  auto request = acquire_request("GET /index.html HTTP/1.0" CRLF
+                                 "Accept-Language: en-US,en;q=0.5,nb;q=0.3" CRLF CRLF);
+  REQUIRE(request.get()     == first);
+  REQUIRE(stats.hits        == hits + 1);
+  REQUIRE(stats.in_use      >= 1);
+  REQUIRE(stats.high_water  >= stats.in_use);
+  REQUIRE(stats.hit_rate()  >  0.0);
+  REQUIRE(request->method() == GET);
+  REQUIRE(request->version() == Version(1, 0));
+  REQUIRE(request->header_size() == 1);
+  REQUIRE(not request->has_header(header_fields::Request::User_Agent));
+  REQUIRE(request->header_value("accept-language"s) == "en-US,en;q=0.5,nb;q=0.3");
+  REQUIRE(request->get_body().empty());
+  //-------------------------
+  agent = request->header_value(header_fields::Request::Accept_Language).data();
+  request->reset();
+  REQUIRE(request->to_string() == "GET / HTTP/1.1" CRLF CRLF);
+  request->parse("GET / HTTP/1.1" CRLF "Accept-Language: nb" CRLF CRLF);
+  REQUIRE(request->header_value(header_fields::Request::Accept_Language).data() == agent);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Objects go back to the pool that handed them out", "[Request]") {
+  const auto local_idle = Pool<Request>::local().idle();
+  //-------------------------
+  Pool<Request> pool {1};
+  {
+    auto first  = pool.acquire();
+    auto second = pool.acquire();
+    REQUIRE(pool.stats().in_use == 2);
+  }
+  REQUIRE(pool.stats().in_use   == 0);
+  REQUIRE(pool.stats().released == 2);
+  REQUIRE(pool.idle()           == 1);
+  REQUIRE(Pool<Request>::local().idle() == local_idle);
+  //-------------------------
+  // A recycled response is as a default constructed one
+  Pool<Response> responses;
+  {
+    auto response = responses.acquire();
+    response->parse("HTTP/1.0 404 Not Found" CRLF "Content-Length: 2" CRLF CRLF "no");
+    response->set_header_limits(Header_limits{2, 64, 128});
+  }
+  auto response = responses.acquire();
+  REQUIRE(responses.stats().hits == 1);
+  REQUIRE(response->to_string() == Response{}.to_string());
+  REQUIRE(response->get_header_limit() == Header_limits{}.fields);
+  REQUIRE(response->get_header_limits().total == Header_limits{}.total);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Parse a request into an arena", "[Request]") {
+  alignas(std::max_align_t) char buffer[4096];
+  std::pmr::monotonic_buffer_resource arena {buffer, sizeof buffer, std::pmr::null_memory_resource()};
+  //-------------------------
+  const string ingress = "POST /reports HTTP/1.1" CRLF
+                         "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:49.0)" CRLF
+                         "Content-Type: application/x-www-form-urlencoded" CRLF
+                         "Content-Length: 49" CRLF CRLF
+                         "title=A+report+with+a+long+enough+body&format=pdf";
+  //-------------------------
+  Request request {ingress, 25, &arena};
+  REQUIRE(request.resource() == &arena);
+  REQUIRE(request.header_value(header_fields::Request::User_Agent) == "Mozilla/5.0 (X11; Linux x86_64; rv:49.0)");
+  REQUIRE(request.post_value("format"s) == "pdf");
+  //-------------------------
+  // Compared as untyped pointers so a failure does not print the
+  // buffer as a string
+  const void* body = request.get_body().data();
+  REQUIRE(body >= static_cast<const void*>(buffer));
+  REQUIRE(body <  static_cast<const void*>(buffer + sizeof buffer));
+  //-------------------------
+  request.add_header("X-Request-Id"s, "f3a9c0e1d2b4-0123456789abcdef"s);
+  REQUIRE(request.to_string().size() == request.serialized_size());
+  //-------------------------
+  Request moved {std::move(request)};
+  REQUIRE(moved.resource() == &arena);
+  REQUIRE(moved.header_value("x-request-id"s) == "f3a9c0e1d2b4-0123456789abcdef");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Header limits reject oversized header sections", "[Header]") {
+  // Storage grows with the fields, so an empty header allocates nothing
+  Header empty {Header_limits{}, std::pmr::null_memory_resource()};
+  REQUIRE(empty.is_empty());
+  REQUIRE(empty.get_limit() == 25);
+  //-------------------------
+  Header header {Header_limits{2, 32, 48}};
+  try {
+    header.add_fields("Host: includeos.org" CRLF "Accept: */*" CRLF "DNT: 1" CRLF CRLF);
+    FAIL("Field count limit not enforced");
+  } catch (const Header_limit_error& error) {
+    REQUIRE(error.status_code() == Request_Header_Fields_Too_Large);
+  }
+  REQUIRE(header.size() == 2);
+  //-------------------------
+  // The limits bound what a peer sends, not a message being built
+  REQUIRE(header.add_field("DNT"s, "1"s));
+  REQUIRE(header.set_field("Accept"s, "text/html,application/xhtml+xml"s));
+  REQUIRE(header.size() == 3);
+  REQUIRE(header.get_value("Accept"s) == "text/html,application/xhtml+xml");
+  //-------------------------
+  Response response;
+  for (int i = 0; i < 30; ++i) response.add_header("X-Field-" + to_string(i), "v"s);
+  REQUIRE(response.header_size() == 30);
+  //-------------------------
+  Header lines {Header_limits{25, 32, 48}};
+  REQUIRE_THROWS_AS(lines.add_fields("Host: includeos.org" CRLF
+                                     "Cookie: session=f3a9c0e1d2b4; theme=dark" CRLF CRLF), const Header_limit_error&);
+  REQUIRE(lines.size() == 1);
+  //-------------------------
+  Header folded {Header_limits{25, 32, 48}};
+  REQUIRE_THROWS_AS(folded.add_fields("Cookie: session=f3a9c0e1d2b4;" CRLF
+                                      " theme=dark" CRLF CRLF), const Header_limit_error&);
+  //-------------------------
+  Header total {Header_limits{25, 32, 48}};
+  REQUIRE_THROWS_AS(total.add_fields("Host: www.includeos.org" CRLF
+                                     "Referer: https://includeos.org/" CRLF CRLF), const Header_limit_error&);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("An overlong request-target maps onto 414", "[Request]") {
+  Request request;
+  request.set_header_limits({25, 16, 65536});
+  //-------------------------
+  try {
+    request.parse("GET /reports/2016/annual/summary.pdf HTTP/1.1" CRLF CRLF);
+    FAIL("Request-target limit not enforced");
+  } catch (const Header_limit_error& error) {
+    REQUIRE(error.status_code() == URI_Too_Long);
+  }
+  //-------------------------
+  request.parse("GET /index.html HTTP/1.1" CRLF CRLF);
+  REQUIRE(request.uri().to_string() == "/index.html");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("A chunked body is decoded when parsing a whole request", "[Request]") {
+  Request request {"POST /upload HTTP/1.1" CRLF
+                   "Transfer-Encoding: gzip, chunked" CRLF CRLF
+                   "4" CRLF "Wiki" CRLF "5;ext=1" CRLF "pedia" CRLF
+                   "0" CRLF "Expires: never" CRLF CRLF ""s};
+  //-------------------------
+  REQUIRE(request.get_body() == "Wikipedia");
+  REQUIRE(request.header_value("Transfer-Encoding"s) == "gzip");
+  REQUIRE(request.get_trailers().get_value("Expires"s) == "never");
+  REQUIRE(not request.has_header("Expires"s));
+  //-------------------------
+  // A trailer field never joins the header section that was checked
+  Request smuggled {"POST /upload HTTP/1.1" CRLF "Host: a" CRLF "Transfer-Encoding: chunked" CRLF CRLF
+                    "0" CRLF "Host: b" CRLF "Authorization: Basic Zm9vOmJhcg==" CRLF CRLF ""s};
+  REQUIRE(smuggled.header_value(Header_id::Host) == "a");
+  REQUIRE(smuggled.header_size() == 1);
+  REQUIRE(not smuggled.has_header(Header_id::Authorization));
+  REQUIRE(smuggled.get_trailers().size() == 2);
+  //-------------------------
+  REQUIRE_THROWS_AS(Request{"POST / HTTP/1.1" CRLF "Transfer-Encoding: chunked" CRLF CRLF "4" CRLF "Wi"s},
+                    const Chunked_error&);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("The entity of a request is delimited by its framing fields", "[Request]") {
+  Request sized {"POST /upload HTTP/1.1" CRLF "Content-Length: 5" CRLF CRLF "HelloGET / HTTP/1.1" CRLF CRLF ""s};
+  REQUIRE(sized.get_body() == "Hello");
+  //-------------------------
+  Request bodiless {"GET / HTTP/1.1" CRLF "Host: a" CRLF CRLF "GET /next HTTP/1.1" CRLF CRLF ""s};
+  REQUIRE(bodiless.get_body().empty());
+  //-------------------------
+  REQUIRE_THROWS_AS(Request{"POST / HTTP/1.1" CRLF "Content-Length: 5" CRLF CRLF "Hel"s}, const Message_error&);
+  REQUIRE_THROWS_AS(Request{"POST / HTTP/1.1" CRLF "Content-Length: 5x" CRLF CRLF "Hello"s}, const Message_error&);
+  REQUIRE_THROWS_AS(Request{"POST / HTTP/1.1" CRLF "Content-Length: 5" CRLF
+                            "Content-Length: 3" CRLF CRLF "Hello"s}, const Message_error&);
+  REQUIRE(Request{"POST / HTTP/1.1" CRLF "Content-Length: 5" CRLF
+                  "Content-Length: 5" CRLF CRLF "Hello"s}.get_body() == "Hello");
+  REQUIRE_THROWS_AS(Request{"POST / HTTP/1.1" CRLF "Content-Length: 4" CRLF
+                            "Transfer-Encoding: chunked" CRLF CRLF "0" CRLF CRLF ""s}, const Message_error&);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Split a buffer of pipelined requests", "[Request]") {
+  const string first    = "POST /reports HTTP/1.1" CRLF "Content-Length: 11" CRLF CRLF "title=Q3&n=";
+  const string second   = "GET /reports/7 HTTP/1.1" CRLF "Host: includeos.org" CRLF CRLF;
+  const string third    = "PUT /reports/7 HTTP/1.1" CRLF "Transfer-Encoding: chunked" CRLF CRLF
+                          "3" CRLF "abc" CRLF "0" CRLF CRLF;
+  const string leftover = "POST /late HTTP/1.1" CRLF "Content-Length: 8" CRLF CRLF "half";
+  const string ingress  = first + CRLF + second + third + leftover;
+  //-------------------------
+  vector<Request> requests;
+  const auto taken = split_requests(ingress, [&requests](Request& request) {
+    requests.push_back(std::move(request));
+  });
+  //-------------------------
+  REQUIRE(requests.size() == 3);
+  REQUIRE(ingress.substr(taken) == leftover);
+  REQUIRE(requests[0].method() == POST);
+  REQUIRE(requests[0].get_body() == "title=Q3&n=");
+  REQUIRE(requests[1].uri().to_string() == "/reports/7");
+  REQUIRE(requests[1].header_value("Host"s) == "includeos.org");
+  REQUIRE(requests[1].get_body().empty());
+  REQUIRE(requests[2].method() == PUT);
+  REQUIRE(requests[2].get_body() == "abc");
+  //-------------------------
+  // The rest completes once more bytes arrive
+  Request request;
+  REQUIRE(request.parse_next(leftover) == 0);
+  REQUIRE(request.parse_next(leftover + "more") == leftover.size() + 4);
+  REQUIRE(request.get_body() == "halfmore");
+  REQUIRE(request.parse_next("GET / HTTP/1.1" CRLF "Host: a") == 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Pipelined requests with bare LF line-endings", "[Request]") {
+  const string ingress = "\n" "GET /a HTTP/1.1\n" "Host: a\n\n"
+                         "GET /b HTTP/1.1\n\n"
+                         "POST /c HTTP/1.1\r\n" "Content-Length: 2\n\r\n" "ok";
+  //-------------------------
+  vector<string> targets;
+  const auto taken = split_requests(ingress, [&targets](Request& request) {
+    targets.push_back(request.uri().to_string() + string{request.get_body()});
+  });
+  //-------------------------
+  REQUIRE(taken == ingress.size());
+  REQUIRE((targets == vector<string>{"/a", "/b", "/cok"}));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("A request arriving a byte at a time is resumed", "[Request]") {
+  const vector<string> ingresses {
+    "POST /sized HTTP/1.1" CRLF "Content-Length: 11" CRLF CRLF "Hello World",
+    "POST /chunked HTTP/1.1" CRLF "Transfer-Encoding: chunked" CRLF CRLF
+    "5" CRLF "Hello" CRLF "6;x=y" CRLF " World" CRLF "0" CRLF "Trace: 1" CRLF CRLF
+  };
+  for (const auto& ingress : ingresses) {
+    Request request;
+    size_t taken {0};
+    for (size_t size = 1; size <= ingress.size() and taken == 0; ++size) {
+      taken = request.parse_next(string_view{ingress}.substr(0, size));
+    }
+    //-------------------------
+    REQUIRE(taken == ingress.size());
+    REQUIRE(request.get_body() == "Hello World");
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("A malformed field line rejects a pipelined request", "[Request]") {
+  const string ingress = "POST / HTTP/1.1\r\nHost: a\r\nBad Line\r\nContent-Length: 24\r\n\r\n"
+                         "GET /admin HTTP/1.1\r\n\r\n";
+  //-------------------------
+  vector<string> targets;
+  REQUIRE_THROWS_AS(split_requests(ingress, [&targets](Request& request) {
+    targets.push_back(request.uri().to_string());
+  }), const Message_error&);
+  REQUIRE(targets.empty());
+  //-------------------------
+  Request request;
+  REQUIRE_THROWS_AS(request.parse_next(ingress), const Message_error&);
+  REQUIRE_THROWS_AS(Request{ingress}, const Message_error&);
+  REQUIRE_THROWS_AS(Request{"GET / HTTP/1.1" CRLF "Bad Name: a" CRLF CRLF ""s}, const Message_error&);
+}
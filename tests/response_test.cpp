@@ -17,6 +17,7 @@
 
 #include <catch.hpp>
 #include <response.hpp>
+#include <mime_types.hpp>
 
 #define CRLF "\r\n"
 
@@ -79,6 +80,31 @@ TEST_CASE("{Date} header field", "[Response]") {
   REQUIRE(test_string == response.to_string());
 }
 
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("{Date} header field value in IMF-fixdate format", "[Response]") {
+  const std::time_t times[] {
+    0, 784111777, 951782400, 951868799, 1456704000, 2147483647,
+    4107542400, 253402300799, -1, -2208988800
+  };
+  //-------------------------
+  for (const auto t : times) {
+    char expected[64];
+    std::strftime(expected, sizeof expected, "%a, %d %b %Y %H:%M:%S GMT", std::gmtime(&t));
+    REQUIRE(http::time::from_time_t(t) == expected);
+  }
+  //-------------------------
+  REQUIRE(http::time::from_time_t(784111777) == "Sun, 06 Nov 1994 08:49:37 GMT");
+  REQUIRE(http::time::from_time_t(253402300800).empty());
+  //-------------------------
+  http::time::Date_cache cache;
+  const auto first = cache.get(784111777);
+  REQUIRE(first == "Sun, 06 Nov 1994 08:49:37 GMT");
+  REQUIRE(cache.get(784111777).data() == first.data());
+  REQUIRE(cache.get(784111778) == "Sun, 06 Nov 1994 08:49:38 GMT");
+  //-------------------------
+  REQUIRE(http::time::date().size() == http::time::imf_fixdate_size);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 TEST_CASE("Change header field value", "[Response]") {
   http::Response response;
@@ -136,3 +162,504 @@ TEST_CASE("Add message body", "[Response]") {
   //-------------------------
   REQUIRE(test_string == response.to_string());
 }
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Parse an upstream response", "[Response]") {
+  string egress = "HTTP/1.0 203 Non-Authoritative Information" CRLF
+                  "Server: IncludeOS/0.7.0" CRLF CRLF;
+  //-------------------------
+  http::Response response {std::move(egress)};
+  //-------------------------
+  REQUIRE(response.status_code()                  == http::status_t::Non_Authoritative);
+  REQUIRE(response.header_value(Response::Server) == "IncludeOS/0.7.0");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Status-Line parser yields the reason phrase as a view", "[Status_line]") {
+  const string egress = "HTTP/1.1 299 Custom 2xx-Phrase" CRLF CRLF;
+  //-------------------------
+  http::Status_line_parts parts;
+  http::parse_status_line(egress.data(), egress.data() + egress.size(), parts);
+  //-------------------------
+  REQUIRE(parts.version == http::Version(1, 1));
+  REQUIRE(parts.code    == 299);
+  REQUIRE(parts.reason  == "Custom 2xx-Phrase");
+  REQUIRE(parts.reason.data() == egress.data() + 13);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Status-Line parser reports the byte offset of an error", "[Status_line]") {
+  const string egress = "HTTP/1.1 20X OK" CRLF CRLF;
+  //-------------------------
+  http::Status_line_parts parts;
+  try {
+    http::parse_status_line(egress.data(), egress.data() + egress.size(), parts);
+    FAIL("Expected Status_line_error");
+  } catch (const http::Status_line_error& error) {
+    REQUIRE(error.offset() == 11);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Parse an upstream response with a body", "[Response]") {
+  const string egress = "HTTP/1.1 200 OK" CRLF
+                        "Content-Type: application/json" CRLF CRLF
+                        "{\"status\": \"ok\"}";
+  //-------------------------
+  http::Response copied {egress};
+  http::Response moved  {string{egress}};
+  //-------------------------
+  REQUIRE(copied.get_body() == "{\"status\": \"ok\"}");
+  REQUIRE(moved.get_body()  == "{\"status\": \"ok\"}");
+  REQUIRE(moved.header_value(Entity::Content_Type) == "application/json");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Serialize a response into a caller buffer", "[Response]") {
+  http::Response response;
+  response.add_header(Response::Server, "IncludeOS/v0.9"s)
+          .add_header(Entity::Content_Type, "application/json"s)
+          .add_body("{\"status\":\"ok\"}"s);
+  //-------------------------
+  const string expected = "HTTP/1.1 200 OK" CRLF
+                          "Server: IncludeOS/v0.9" CRLF
+                          "Content-Type: application/json" CRLF
+                          "Content-Length: 15" CRLF CRLF
+                          "{\"status\":\"ok\"}";
+  //-------------------------
+  REQUIRE(response.serialized_size() == expected.size());
+  //-------------------------
+  vector<char> buffer(response.serialized_size());
+  const char* end = response.serialize_into(buffer.data());
+  REQUIRE(end - buffer.data() == static_cast<ptrdiff_t>(buffer.size()));
+  REQUIRE(string(buffer.begin(), buffer.end()) == expected);
+  //-------------------------
+  string out {"prefix"};
+  response.append_to(out);
+  REQUIRE(out == "prefix" + expected);
+  REQUIRE(response.to_string() == expected);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Serialize a status-line with multi-digit version numbers", "[Status_line]") {
+  http::Status_line status_line {http::Version{10, 12}, http::Not_Found};
+  //-------------------------
+  REQUIRE(status_line.to_string()       == "HTTP/10.12 404 Not Found" CRLF);
+  REQUIRE(status_line.serialized_size() == status_line.to_string().size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Export a response as segments without copying the body", "[Response]") {
+  http::Response response;
+  response.add_header(Entity::Content_Type, "application/json"s)
+          .add_body(string(100000, 'x'));
+  //-------------------------
+  auto segments = response.export_iovecs();
+  //-------------------------
+  REQUIRE(segments.size() == 3u);
+  REQUIRE(segments[2].base   == response.get_body().data());
+  REQUIRE(segments[2].length == 100000u);
+  //-------------------------
+  string joined;
+  for (const auto& segment : segments) {
+    joined.append(static_cast<const char*>(segment.base), segment.length);
+  }
+  REQUIRE(joined == response.to_string());
+  REQUIRE(string(static_cast<const char*>(segments[0].base), segments[0].length) == "HTTP/1.1 200 OK" CRLF);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Status-lines come from the compile-time table", "[Status_line]") {
+  static_assert(http::status_line_bytes(200, 1, 1) == "HTTP/1.1 200 OK\r\n", "");
+  static_assert(http::is_client_error(http::Not_Found), "");
+  //-------------------------
+  for (const auto& status : http::status_codes) {
+    for (unsigned minor = 0; minor < 2; ++minor) {
+      http::Status_line status_line {http::Version{1, minor}, status.code};
+      REQUIRE(status_line.prerendered()
+              == "HTTP/1." + to_string(minor) + ' ' + to_string(status.code) + ' ' + status.description + CRLF);
+    }
+  }
+  //-------------------------
+  REQUIRE(http::Status_line(http::Version{1, 0}, http::Not_Found).to_string() == "HTTP/1.0 404 Not Found" CRLF);
+  REQUIRE(http::Status_line(http::Version{2, 0}, http::OK).prerendered().empty());
+  REQUIRE(http::Status_line(http::Version{2, 0}, http::OK).to_string()        == "HTTP/2.0 200 OK" CRLF);
+  REQUIRE(http::Status_line(http::Version{1, 1}, 299).to_string()             == "HTTP/1.1 299 Internal Server Error" CRLF);
+  //-------------------------
+  REQUIRE(http::is_informational(http::Processing));
+  REQUIRE(http::is_success(static_cast<http::status_t>(210)));
+  REQUIRE(http::is_redirection(http::Permanent_Redirect));
+  REQUIRE(http::is_server_error(http::Network_Authentication_Required));
+  REQUIRE(not http::is_success(static_cast<http::status_t>(600)));
+  REQUIRE(not http::is_client_error(static_cast<http::status_t>(99)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("MIME type of a file extension", "[Response]") {
+  static_assert(http::builtin_extension_to_type("css") == "text/css", "");
+  //-------------------------
+  for (const auto& mapping : http::mime_types) {
+    REQUIRE(http::extension_to_type(mapping.extension) == mapping.type);
+  }
+  //-------------------------
+  REQUIRE(http::extension_to_type("json")    == "application/json");
+  REQUIRE(http::extension_to_type("unknown") == "application/octet-stream");
+  REQUIRE(http::extension_to_type("")        == "application/octet-stream");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("MIME type of the resource at a path", "[Response]") {
+  REQUIRE(http::extension_to_type("HTML") == "text/html");
+  REQUIRE(http::extension_to_type("Png")  == "image/png");
+  //-------------------------
+  REQUIRE(http::path_to_type("/index.html")            == "text/html");
+  REQUIRE(http::path_to_type("/static/app.min.JS?v=2") == "text/javascript");
+  REQUIRE(http::path_to_type("/a.b/style.css#top")     == "text/css");
+  REQUIRE(http::path_to_type("/a.b/README")            == "application/octet-stream");
+  REQUIRE(http::path_to_type("/.htaccess")             == "application/octet-stream");
+  REQUIRE(http::path_to_type("/")                      == "application/octet-stream");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Load a MIME type table", "[Response]") {
+  const http::Mime_table table {
+    "# comment\n"
+    "text/x-first   foo BAR\n"
+    "\n"
+    "text/x-second  foo baz  # trailing comment\n"
+    "not-a-type     qux\n"
+  };
+  //-------------------------
+  REQUIRE(table.size() == 3);
+  REQUIRE(table.find("foo") == "text/x-first");
+  REQUIRE(table.find("bar") == "text/x-first");
+  REQUIRE(table.find("BAZ") == "text/x-second");
+  REQUIRE(table.find("qux").empty());
+  REQUIRE(table.find("").empty());
+  //-------------------------
+  std::string text;
+  for (int i = 0; i < 2000; ++i) {
+    text += "application/x-" + std::to_string(i) + " e" + std::to_string(i) + '\n';
+  }
+  //-------------------------
+  const http::Mime_table large {text};
+  REQUIRE(large.size() == 2000);
+  for (int i = 0; i < 2000; ++i) {
+    REQUIRE(large.find('e' + std::to_string(i)) == "application/x-" + std::to_string(i));
+  }
+  REQUIRE(large.find("e2000").empty());
+  //-------------------------
+  REQUIRE(http::Mime_table{}.find("html").empty());
+  REQUIRE_THROWS_AS(http::Mime_table::from_file("/nonexistent/mime.types"), const http::Mime_table_error&);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Header field names and values as views", "[Response]") {
+  http::Response response;
+  response.add_header(Entity::Content_Type, "text/html")
+          .set_header(Response::Server, string_view{"IncludeOS"});
+  //-------------------------
+  REQUIRE(response.has_header(Entity::Content_Type));
+  REQUIRE(response.header_value("content-type") == "text/html");
+  REQUIRE(response.header_value(Response::Server) == "IncludeOS");
+  //-------------------------
+  response.erase_header(Entity::Content_Type);
+  REQUIRE(not response.has_header("Content-Type"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Header fields share one buffer", "[Header]") {
+  http::Header header;
+  header.add_field(Response::Server, "IncludeOS"s);
+  header.add_field(Entity::Content_Type, "text/html"s);
+  header.add_field("X-Trace"s, "a1"s);
+  //-------------------------
+  vector<pair<string, string>> fields;
+  for (const auto field : header) fields.emplace_back(field.name, field.value);
+  REQUIRE(fields == (vector<pair<string, string>>{
+    {"Server", "IncludeOS"}, {"Content-Type", "text/html"}, {"X-Trace", "a1"}
+  }));
+  //-------------------------
+  // Shrinking a value happens in place, growing one moves it
+  header.set_field(Response::Server, "Inc"s);
+  header.set_field("x-trace"s, "a1b2c3d4e5f6a7b8c9d0e1f2a3b4c5d6"s);
+  REQUIRE(header.get_value(Response::Server) == "Inc");
+  REQUIRE(header.get_value("X-Trace"s) == "a1b2c3d4e5f6a7b8c9d0e1f2a3b4c5d6");
+  //-------------------------
+  // A value may come from the header itself
+  header.add_field("X-Copy"s, header.get_value("X-Trace"s));
+  REQUIRE(header.get_value("X-Copy"s) == "a1b2c3d4e5f6a7b8c9d0e1f2a3b4c5d6");
+  //-------------------------
+  header.erase(Entity::Content_Type);
+  REQUIRE(not header.has_field(Entity::Content_Type));
+  REQUIRE(header.size() == 3);
+  //-------------------------
+  for (int i = 0; i < 100; ++i) header.set_field("X-Trace"s, string(i + 40, 'x'));
+  REQUIRE(header.get_value("X-Trace"s) == string(139, 'x'));
+  REQUIRE(header.get_value(Response::Server) == "Inc");
+  REQUIRE(header.get_value("X-Copy"s) == "a1b2c3d4e5f6a7b8c9d0e1f2a3b4c5d6");
+  REQUIRE(header.to_string() == "Server: Inc\r\n"
+                                "X-Trace: " + string(139, 'x') + "\r\n"
+                                "X-Copy: a1b2c3d4e5f6a7b8c9d0e1f2a3b4c5d6\r\n\r\n");
+  //-------------------------
+  header.clear();
+  REQUIRE(header.begin() == header.end());
+  REQUIRE(header.add_field(Response::Server, "IncludeOS"s));
+  REQUIRE(header.to_string() == "Server: IncludeOS\r\n\r\n");
+  //-------------------------
+  // A name taken from the header itself survives the buffer growing
+  http::Header aliased;
+  aliased.add_field("X-Correlation-Identifier"s, "1"s);
+  for (int i = 0; i < 8; ++i) REQUIRE(aliased.add_field((*aliased.begin()).name, "x"s));
+  REQUIRE(aliased.size() == 9);
+  REQUIRE(std::all_of(aliased.begin(), aliased.end(), [](const auto& f) {
+    return f.name == "X-Correlation-Identifier";
+  }));
+  REQUIRE(aliased.get_value("x-correlation-identifier"s) == "1");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Bodies held as a rope, a file region or a generator", "[Response]") {
+  // Records how each part of a message was handed over
+  struct Recorder : http::Writer {
+    string out;
+    size_t writes {0};
+    size_t files  {0};
+    void write(string_view bytes) override { out.append(bytes); ++writes; }
+    void write_file(const int fd, const off_t offset, const size_t length) override {
+      ++files;
+      Writer::write_file(fd, offset, length);
+    }
+  };
+  //-------------------------
+  // Rope: appends never move earlier chunks
+  http::Body rope;
+  rope.append("Once upon a time"s).to_rope();
+  const void* first = rope.chunks().front().data();
+  rope.append(string(10000, 'x'));
+  rope.append_chunk(std::pmr::string{"The end"});
+  REQUIRE(rope.kind() == http::Body::Kind::Rope);
+  REQUIRE(rope.size() == 16 + 10000 + 7);
+  REQUIRE(static_cast<const void*>(rope.chunks().front().data()) == first);
+  //-------------------------
+  http::Response response;
+  response.set_body(rope);
+  REQUIRE(response.content_length() == 10023);
+  //-------------------------
+  const auto& segments = response.export_iovecs();
+  REQUIRE(segments.size() == 2 + rope.chunks().size());
+  string joined;
+  for (const auto& segment : segments) joined.append(static_cast<const char*>(segment.base), segment.length);
+  REQUIRE(joined == response.to_string());
+  //-------------------------
+  // File region: handed to the writer as a region, not as bytes
+  unique_ptr<FILE, int(*)(FILE*)> file {tmpfile(), fclose};
+  REQUIRE(file);
+  const string contents = "<html>" + string(20000, '.') + "</html>";
+  REQUIRE(fwrite(contents.data(), 1, contents.size(), file.get()) == contents.size());
+  fflush(file.get());
+  //-------------------------
+  http::Body region;
+  region.assign_file({fileno(file.get()), 6, 20000});
+  response.set_body(region);
+  REQUIRE(response.content_length() == 20000);
+  REQUIRE_THROWS_AS(response.export_iovecs(), const http::Body_error&);
+  //-------------------------
+  Recorder recorder;
+  response.write_to(recorder);
+  REQUIRE(recorder.files == 1);
+  REQUIRE(recorder.out == response.to_string());
+  REQUIRE(recorder.out.substr(recorder.out.size() - 20000) == string(20000, '.'));
+  //-------------------------
+  // Generator: produced while writing, of unknown length
+  size_t remaining = 50000;
+  http::Body generated;
+  generated.assign_generator([&remaining](char* out, size_t capacity) {
+    const auto n = min(remaining, capacity);
+    fill(out, out + n, 'g');
+    remaining -= n;
+    return n;
+  });
+  response.set_body(std::move(generated));
+  REQUIRE(response.content_length() == http::Body::unknown_size);
+  //-------------------------
+  Recorder streamed;
+  response.write_to(streamed);
+  REQUIRE(streamed.writes > 2);
+  //-------------------------
+  // Nothing else delimits it, so it is framed as chunked
+  const string head = "HTTP/1.1 200 OK" CRLF "Transfer-Encoding: chunked" CRLF CRLF;
+  REQUIRE(streamed.out.compare(0, head.size(), head) == 0);
+  REQUIRE(http::Response{streamed.out}.get_body() == string(50000, 'g'));
+  REQUIRE(response.get_header().size() == 0);
+  //-------------------------
+  // A generator must produce exactly its declared length
+  for (const size_t produced : {size_t{900}, size_t{1100}}) {
+    size_t left = produced;
+    http::Body declared;
+    declared.assign_generator([&left](char* out, size_t capacity) {
+      const auto n = min(left, capacity);
+      fill(out, out + n, 'd');
+      left -= n;
+      return n;
+    }, 1000);
+    //-------------------------
+    Recorder checked;
+    REQUIRE_THROWS_AS(declared.write_to(checked), const http::Body_error&);
+    REQUIRE(checked.out.size() <= 1000);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("{Content-Length} is derived from the body when serializing", "[Response]") {
+  http::Response response;
+  response.add_header(Response::Server, "IncludeOS"s);
+  for (int i = 0; i < 500; ++i) response.append_body("ab"s);
+  //-------------------------
+  // Appending leaves the header section alone
+  REQUIRE(response.header_size() == 1);
+  REQUIRE(response.content_length() == 1000);
+  //-------------------------
+  const string head = "HTTP/1.1 200 OK" CRLF
+                      "Server: IncludeOS" CRLF
+                      "Content-Length: 1000" CRLF CRLF;
+  REQUIRE(response.to_string() == head + string{response.get_body()});
+  REQUIRE(response.serialized_size() == head.size() + 1000);
+  //-------------------------
+  const auto& segments = response.export_iovecs();
+  REQUIRE(string(static_cast<const char*>(segments[1].base), segments[1].length)
+          == "Server: IncludeOS" CRLF "Content-Length: 1000" CRLF CRLF);
+  //-------------------------
+  // An explicit field overrides the derived one, e.g. for a reply to HEAD
+  response.add_header(Entity::Content_Length, "4096"s);
+  REQUIRE(response.content_length() == 4096);
+  REQUIRE(response.to_string().find("Content-Length: 1000") == string::npos);
+  REQUIRE(response.to_string().find("Content-Length: 4096") not_eq string::npos);
+  //-------------------------
+  response.clear_body();
+  REQUIRE(response.to_string() == "HTTP/1.1 200 OK" CRLF "Server: IncludeOS" CRLF CRLF);
+  //-------------------------
+  // Changing the entity drops an explicit field that would no longer match
+  response.add_header(Entity::Content_Length, "4"s);
+  response.add_body("replaced"s);
+  REQUIRE(response.content_length() == 8);
+  REQUIRE(response.to_string() == "HTTP/1.1 200 OK" CRLF "Server: IncludeOS" CRLF
+                                  "Content-Length: 8" CRLF CRLF "replaced");
+  response.add_header(Entity::Content_Length, "8"s);
+  response.append_body("!"s);
+  REQUIRE(response.to_string().find("Content-Length: 9" CRLF CRLF "replaced!") not_eq string::npos);
+  response.add_header(Entity::Content_Length, "9"s);
+  response.set_body(http::Body{});
+  REQUIRE(response.has_header(Entity::Content_Length) == false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Stream a response body in the chunked transfer coding", "[Response]") {
+  http::Response response;
+  response.add_header(Response::Server, "IncludeOS"s);
+  response.add_header(Entity::Content_Length, "3"s);
+  response.add_body("abc"s);
+  //-------------------------
+  string egress;
+  http::String_writer writer {egress};
+  auto stream = response.stream(writer);
+  //-------------------------
+  // The head and the body held so far leave before the rest is produced
+  REQUIRE(egress == "HTTP/1.1 200 OK" CRLF
+                    "Server: IncludeOS" CRLF
+                    "Transfer-Encoding: chunked" CRLF CRLF
+                    "3" CRLF "abc" CRLF);
+  //-------------------------
+  const string large(2000, 'x');
+  stream.write("Hello"sv).write(""sv).write(large);
+  stream.add_trailer("Checksum"s, "f00d"s);
+  stream.finish();
+  REQUIRE(stream.finished());
+  REQUIRE(stream.body_size() == 3 + 5 + large.size());
+  REQUIRE_THROWS_AS(stream.write("late"sv), const http::Chunked_error&);
+  REQUIRE_THROWS_AS(stream.add_trailer(Entity::Content_Length, "9"s), const http::Chunked_error&);
+  //-------------------------
+  const auto start_of_body = egress.find(CRLF CRLF) + 4;
+  REQUIRE(egress.substr(start_of_body, 27) == "3" CRLF "abc" CRLF "5" CRLF "Hello" CRLF "7d0" CRLF "xxxx");
+  //-------------------------
+  http::Response parsed {egress};
+  REQUIRE(parsed.get_body() == "abcHello" + large);
+  REQUIRE(parsed.get_trailers().get_value("Checksum"s) == "f00d");
+  REQUIRE(parsed.has_header("Transfer-Encoding"s) == false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("A streamed body keeps its other transfer codings", "[Response]") {
+  http::Response response;
+  response.add_header(General::Transfer_Encoding, "gzip"s);
+  //-------------------------
+  string egress;
+  http::String_writer writer {egress};
+  response.stream(writer).finish();
+  //-------------------------
+  REQUIRE(egress == "HTTP/1.1 200 OK" CRLF "Transfer-Encoding: gzip, chunked" CRLF CRLF "0" CRLF CRLF);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Framing fields are never sent as trailers", "[Response]") {
+  string egress;
+  http::String_writer writer {egress};
+  http::Chunked_encoder encoder {writer};
+  encoder.write("abc"sv);
+  //-------------------------
+  http::Header trailers;
+  trailers.add_field("transfer-encoding"s, "gzip"s);
+  REQUIRE_THROWS_AS(encoder.finish(trailers), const http::Chunked_error&);
+  REQUIRE(encoder.finished() == false);
+  REQUIRE(egress == "3" CRLF "abc" CRLF);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Responses that never carry an entity", "[Response]") {
+  http::Response not_modified {"HTTP/1.1 304 Not Modified" CRLF "Content-Length: 1234" CRLF CRLF ""s};
+  REQUIRE(not_modified.status_code() == http::Not_Modified);
+  REQUIRE(not_modified.get_body().empty());
+  REQUIRE(not_modified.content_length() == 1234);
+  //-------------------------
+  http::Response no_content {"HTTP/1.1 204 No Content" CRLF "Content-Length: 5" CRLF CRLF "stray"s};
+  REQUIRE(no_content.get_body().empty());
+  //-------------------------
+  http::Response head;
+  head.parse("HTTP/1.1 200 OK" CRLF "Content-Length: 4096" CRLF CRLF, http::HEAD);
+  REQUIRE(head.status_code() == http::OK);
+  REQUIRE(head.get_body().empty());
+  REQUIRE(head.content_length() == 4096);
+  //-------------------------
+  REQUIRE_THROWS_AS(head.parse("HTTP/1.1 200 OK" CRLF "Content-Length: 4096" CRLF CRLF), const http::Message_error&);
+  head.parse("HTTP/1.1 200 OK" CRLF "Content-Length: 2" CRLF CRLF "ok");
+  REQUIRE(head.get_body() == "ok");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("An explicit chunked coding frames a body of known length", "[Response]") {
+  http::Response response;
+  response.add_header(General::Transfer_Encoding, "gzip, chunked"s);
+  response.add_body("Hello World"s);
+  //-------------------------
+  const string expected = "HTTP/1.1 200 OK" CRLF "Transfer-Encoding: gzip, chunked" CRLF CRLF
+                          "b" CRLF "Hello World" CRLF "0" CRLF CRLF;
+  REQUIRE(response.to_string() == expected);
+  REQUIRE(response.serialized_size() == expected.size());
+  //-------------------------
+  string egress;
+  http::String_writer writer {egress};
+  response.write_to(writer);
+  REQUIRE(egress == expected);
+  //-------------------------
+  string joined;
+  for (const auto& segment : response.export_iovecs()) {
+    joined.append(static_cast<const char*>(segment.base), segment.length);
+  }
+  REQUIRE(joined == expected);
+  //-------------------------
+  http::Response parsed {expected};
+  REQUIRE(parsed.get_body() == "Hello World");
+  //-------------------------
+  response.clear_body();
+  REQUIRE(response.to_string() == "HTTP/1.1 200 OK" CRLF "Transfer-Encoding: gzip, chunked" CRLF CRLF "0" CRLF CRLF);
+}
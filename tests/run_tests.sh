@@ -25,3 +25,7 @@ echo "Testing request module...";
 ./request;
 echo "Testing response module...";
 ./response;
+echo "Testing parser module...";
+./parser;
+echo "Testing time module...";
+./time;
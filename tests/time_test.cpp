@@ -0,0 +1,101 @@
+// This file is a part of the IncludeOS unikernel - www.includeos.org
+//
+// Copyright 2015-2016 Oslo and Akershus University College of Applied Sciences
+// and Alfred Bratterud
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <ctime>
+#include <random>
+#include <catch.hpp>
+#include <time.hpp>
+
+using namespace std;
+using namespace http::time;
+
+static std::time_t parse(const string& text) {
+  std::time_t time {-1};
+  REQUIRE(parse_http_date(text, time));
+  return time;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Parse the three HTTP-date formats", "[Time]") {
+  REQUIRE(parse("Sun, 06 Nov 1994 08:49:37 GMT")  == 784111777);
+  REQUIRE(parse("Sunday, 06-Nov-94 08:49:37 GMT") == 784111777);
+  REQUIRE(parse("Sun Nov  6 08:49:37 1994")       == 784111777);
+  REQUIRE(parse("Sun Nov 6 08:49:37 1994")        == 784111777);
+  REQUIRE(parse("Sun Nov 06 08:49:37 1994")       == 784111777);
+  //-------------------------
+  REQUIRE(parse("Thu, 01 Jan 1970 00:00:00 GMT")  == 0);
+  REQUIRE(parse("Thursday, 01-Jan-70 00:00:00 GMT") == 0);
+  REQUIRE(parse("Tuesday, 29-Feb-00 12:00:00 GMT") == 951825600);
+  REQUIRE(parse("sun, 06 nov 1994 08:49:37 GMT")  == 784111777);
+  REQUIRE(to_time_t("Sun, 06 Nov 1994 08:49:37 GMT") == 784111777);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Reject malformed HTTP-dates", "[Time]") {
+  const char* invalid[] {
+    "",
+    "Sun, 06 Nov 1994 08:49:37",
+    "Sun, 06 Nov 1994 08:49:37 UTC",
+    "Sun, 06 Nov 1994 08:49:37 GMT ",
+    "Sun, 6 Nov 1994 08:49:37 GMT",
+    "Sun, 06 Nox 1994 08:49:37 GMT",
+    "Sun, 00 Nov 1994 08:49:37 GMT",
+    "Sun, 32 Nov 1994 08:49:37 GMT",
+    "Sun, 06 Nov 1994 24:49:37 GMT",
+    "Sun, 06 Nov 1994 08:60:37 GMT",
+    "Sun, 06 Nov 94 08:49:37 GMT",
+    "Sunday, 06-Nov-1994 08:49:37 GMT",
+    "Sunday 06-Nov-94 08:49:37 GMT",
+    "Sun Nov  6 08:49:37 94",
+    "Sun Nov   6 08:49:37 1994",
+    "Sunday Nov  6 08:49:37 1994",
+    "06 Nov 1994 08:49:37 GMT",
+  };
+  //-------------------------
+  for (const auto text : invalid) {
+    std::time_t time {42};
+    INFO(text);
+    REQUIRE(not parse_http_date(text, time));
+    REQUIRE(time == 42);
+    REQUIRE(to_time_t(text) == 0);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TEST_CASE("Parsed HTTP-dates agree with timegm", "[Time]") {
+  std::mt19937_64 random {1994};
+  std::uniform_int_distribution<int64_t> seconds {0, 253402300799};
+  //-------------------------
+  for (int i = 0; i < 10000; ++i) {
+    const std::time_t t = seconds(random);
+    std::tm tm = *std::gmtime(&t);
+    //-------------------------
+    char imf[64], rfc850[64], asctime[64];
+    std::strftime(imf,     sizeof imf,     "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    std::strftime(rfc850,  sizeof rfc850,  "%A, %d-%b-%y %H:%M:%S GMT", &tm);
+    std::strftime(asctime, sizeof asctime, "%a %b %e %H:%M:%S %Y", &tm);
+    //-------------------------
+    const auto expected = timegm(&tm);
+    REQUIRE(parse(imf)     == expected);
+    REQUIRE(parse(asctime) == expected);
+    REQUIRE(from_time_t(parse(imf)) == imf);
+    //-------------------------
+    if (tm.tm_year >= 69 and tm.tm_year < 169) {
+      REQUIRE(parse(rfc850) == expected);
+    }
+  }
+}